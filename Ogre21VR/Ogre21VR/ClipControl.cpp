@@ -0,0 +1,15 @@
+#include "ClipControl.hpp"
+
+#include <stdexcept>
+
+#include <GLFW/glfw3.h>
+
+void setClipDepthRange(bool zeroToOne)
+{
+	using glClipControlProc = void(APIENTRY *)(GLenum origin, GLenum depth);
+	static const auto glClipControl = reinterpret_cast<glClipControlProc>(glfwGetProcAddress("glClipControl"));
+	if (!glClipControl)
+		throw std::runtime_error("Reverse depth needs glClipControl (OpenGL 4.5 or ARB_clip_control)");
+
+	glClipControl(GL_LOWER_LEFT, zeroToOne ? GL_ZERO_TO_ONE : GL_NEGATIVE_ONE_TO_ONE);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <Windows.h>
+
+//OpenGL extension loading
+#include <GL/gl3w.h>
+
+//glClipControl is GL 4.5, not loaded by gl3w
+#ifndef GL_ZERO_TO_ONE
+#define GL_LOWER_LEFT 0x8CA1
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+
+///Set the depth range of the clip space : [0; 1] for the reversed depth, [-1; 1] like Ogre's projection matrices otherwise.
+///Throws if the driver has neither OpenGL 4.5 nor ARB_clip_control
+void setClipDepthRange(bool zeroToOne);
@@ -0,0 +1,142 @@
+#include "FrameArena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+
+namespace
+{
+	///Scratch arenas start at this size, and grow like any other
+	constexpr size_t scratchCapacity{ 64 * 1024 };
+
+	std::mutex scratchMutex;
+	std::vector<const LinearArena*> scratchArenas;
+
+	///Scratch arena of a thread, known by getTotalCapacity() while the thread lives
+	struct ScratchArena
+	{
+		LinearArena arena{ scratchCapacity };
+
+		ScratchArena()
+		{
+			std::lock_guard<std::mutex> lock{ scratchMutex };
+			scratchArenas.push_back(&arena);
+		}
+
+		~ScratchArena()
+		{
+			std::lock_guard<std::mutex> lock{ scratchMutex };
+			scratchArenas.erase(std::find(scratchArenas.begin(), scratchArenas.end(), &arena));
+		}
+	};
+
+	LinearArena& threadScratchArena()
+	{
+		thread_local ScratchArena scratch;
+		return scratch.arena;
+	}
+
+	char* alignUp(char* address, size_t alignment)
+	{
+		const auto value = reinterpret_cast<uintptr_t>(address);
+		return address + (alignment - value % alignment) % alignment;
+	}
+}
+
+LinearArena::LinearArena(size_t capacity) :
+	block{ capacity ? new char[capacity] : nullptr },
+	capacity{ capacity },
+	offset{ 0 },
+	used{ 0 },
+	highWater{ 0 }
+{
+}
+
+void* LinearArena::allocate(size_t bytes, size_t alignment)
+{
+	if (block)
+	{
+		auto address = alignUp(block.get() + offset, alignment);
+		const auto end = size_t(address - block.get()) + bytes;
+		if (end <= capacity)
+		{
+			used += end - offset;
+			offset = end;
+			highWater = std::max(highWater, used);
+			return address;
+		}
+	}
+
+	//Doesn't fit : take it from the heap until the next reset, that will make the block large enough
+	overflow.emplace_back(new char[bytes + alignment]);
+	used += bytes + alignment;
+	highWater = std::max(highWater, used);
+	return alignUp(overflow.back().get(), alignment);
+}
+
+void LinearArena::reset()
+{
+	if (!overflow.empty())
+	{
+		capacity = highWater + highWater / 2;
+		block.reset(new char[capacity]);
+		overflow.clear();
+	}
+	offset = 0;
+	used = 0;
+}
+
+LinearArena::Marker LinearArena::getMarker() const
+{
+	return { offset, used, overflow.size() };
+}
+
+void LinearArena::rewind(const Marker& marker)
+{
+	if (marker.used == 0)
+		return reset();
+
+	offset = marker.offset;
+	used = marker.used;
+	overflow.resize(marker.overflowCount);
+}
+
+size_t LinearArena::getCapacity() const
+{
+	return capacity;
+}
+
+size_t LinearArena::getUsed() const
+{
+	return used;
+}
+
+size_t LinearArena::getHighWater() const
+{
+	return highWater;
+}
+
+ScratchScope::ScratchScope() :
+	arena{ threadScratchArena() },
+	marker{ arena.getMarker() }
+{
+}
+
+ScratchScope::~ScratchScope()
+{
+	arena.rewind(marker);
+}
+
+LinearArena& ScratchScope::getArena() const
+{
+	return arena;
+}
+
+size_t ScratchScope::getTotalCapacity()
+{
+	std::lock_guard<std::mutex> lock{ scratchMutex };
+	size_t capacity{ 0 };
+	for (auto scratch : scratchArenas)
+		capacity += scratch->getCapacity();
+	return capacity;
+}
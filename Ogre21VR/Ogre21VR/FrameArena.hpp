@@ -0,0 +1,133 @@
+#pragma once
+
+//C++ standard libraries
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+///Bump allocator for data that doesn't outlive a frame, or a scope. Nothing is freed one by one : reset() drops everything at once.
+///A frame needing more than the capacity gets the extra from the heap, and the arena grows to its high water mark at the next
+///reset. After a few frames, the steady state doesn't allocate anymore
+class LinearArena
+{
+public:
+	///Where the arena was at some point, to rewind to it
+	struct Marker
+	{
+		size_t offset;
+		size_t used;
+		size_t overflowCount;
+	};
+
+	explicit LinearArena(size_t capacity = 0);
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+	template <typename T> T* allocateArray(size_t count)
+	{
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+	///Construct an object in the arena. Its destructor will never run : keep to types that don't own anything
+	template <typename T, typename... Args> T* create(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "The arena never destroys what it holds");
+		return new (allocateArray<T>(1)) T(std::forward<Args>(args)...);
+	}
+
+	///Free everything, and grow to the high water mark if the arena overflowed
+	void reset();
+	Marker getMarker() const;
+	///Free everything allocated since "marker". Rewinding to an empty arena resets it
+	void rewind(const Marker& marker);
+
+	size_t getCapacity() const;
+	///Bytes allocated since the last reset, overflow included
+	size_t getUsed() const;
+	///Most bytes used between two resets
+	size_t getHighWater() const;
+
+private:
+	std::unique_ptr<char[]> block;
+	size_t capacity;
+	size_t offset;
+	size_t used;
+	size_t highWater;
+	///Allocations that didn't fit in the block, until the next reset
+	std::vector<std::unique_ptr<char[]>> overflow;
+};
+
+///Standard allocator over a LinearArena, so the containers of a frame can use it. Deallocation does nothing
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(LinearArena& arena) :
+		arena{ &arena }
+	{
+	}
+
+	template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) :
+		arena{ other.getArena() }
+	{
+	}
+
+	T* allocate(size_t count)
+	{
+		return arena->allocateArray<T>(count);
+	}
+
+	void deallocate(T*, size_t)
+	{
+	}
+
+	LinearArena* getArena() const
+	{
+		return arena;
+	}
+
+	template <typename U> bool operator==(const ArenaAllocator<U>& other) const
+	{
+		return arena == other.getArena();
+	}
+
+	template <typename U> bool operator!=(const ArenaAllocator<U>& other) const
+	{
+		return arena != other.getArena();
+	}
+
+private:
+	LinearArena* arena;
+};
+
+///A vector living in an arena. It must not outlive the frame or the scratch scope it was made in
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+///Scratch arena of the calling thread, for the temporaries of a function. Everything allocated in it while the scope lives
+///is freed when it ends. Scopes can be nested, and work on any thread (the scene manager workers included)
+class ScratchScope
+{
+public:
+	ScratchScope();
+	~ScratchScope();
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	LinearArena& getArena() const;
+	template <typename T> ArenaVector<T> makeVector() const
+	{
+		return ArenaVector<T>(ArenaAllocator<T>(arena));
+	}
+
+	///Capacity of the scratch arenas of all the threads, for the memory tracker
+	static size_t getTotalCapacity();
+
+private:
+	LinearArena& arena;
+	const LinearArena::Marker marker;
+};
@@ -0,0 +1,114 @@
+#include "FrameUploadRing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+FrameUploadRing::FrameUploadRing(size_t bytesPerFrame, size_t frameCount) :
+	buffer{ 0 },
+	mapped{ nullptr },
+	regionSize{ 0 },
+	alignment{ 256 },
+	fences(frameCount, nullptr),
+	region{ frameCount - 1 },
+	head{ 0 },
+	frame{ 0 },
+	lastStallMs{ 0 }
+{
+	GLint uniformAlignment{ 0 }, textureAlignment{ 0 };
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+	glGetIntegerv(GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT, &textureAlignment);
+	if (uniformAlignment > 0 || textureAlignment > 0) alignment = size_t(std::max<GLint>(uniformAlignment, textureAlignment));
+
+	//Keep every region start aligned, so the offsets inside a region only depend on the allocations
+	regionSize = (bytesPerFrame + alignment - 1) / alignment * alignment;
+
+	//Mapped once for the lifetime of the buffer. Coherent, so there is nothing to flush before drawing
+	const GLbitfield flags{ GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferStorage(GL_UNIFORM_BUFFER, regionSize * frameCount, nullptr, flags);
+	mapped = static_cast<GLubyte*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, regionSize * frameCount, flags));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (!mapped) throw std::runtime_error("Cannot map the frame upload ring. Persistent mapping needs OpenGL 4.4");
+}
+
+FrameUploadRing::~FrameUploadRing()
+{
+	for (auto fence : fences)
+		if (fence) glDeleteSync(fence);
+
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glUnmapBuffer(GL_UNIFORM_BUFFER);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glDeleteBuffers(1, &buffer);
+}
+
+void FrameUploadRing::beginFrame()
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	region = (region + 1) % fences.size();
+	head = 0;
+	++frame;
+
+	//The region was last written "frameCount" frames ago. Unless the GPU is that late, this doesn't wait
+	if (auto& fence = fences[region])
+	{
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	lastStallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FrameUploadRing::endFrame()
+{
+	if (fences[region]) glDeleteSync(fences[region]);
+	fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+FrameUploadRing::Allocation FrameUploadRing::allocate(size_t size)
+{
+	const auto alignedSize = (size + alignment - 1) / alignment * alignment;
+	if (head + alignedSize > regionSize)
+		throw std::runtime_error("Frame upload ring is full, create it with a bigger size per frame");
+
+	const auto offset = region * regionSize + head;
+	head += alignedSize;
+	return { mapped + offset, GLintptr(offset), GLsizeiptr(size) };
+}
+
+void FrameUploadRing::bind(GLuint binding, const Allocation& allocation) const
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, allocation.offset, allocation.size);
+}
+
+void FrameUploadRing::bindTexture(GLuint unit, GLuint texture, GLenum internalFormat, const Allocation& allocation) const
+{
+	//Ogre caches the active unit, it must find it as it left it
+	GLint activeTexture{ 0 };
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBufferRange(GL_TEXTURE_BUFFER, internalFormat, buffer, allocation.offset, allocation.size);
+	glActiveTexture(GLenum(activeTexture));
+}
+
+size_t FrameUploadRing::getCapacity() const
+{
+	return regionSize * fences.size();
+}
+
+size_t FrameUploadRing::getFrame() const
+{
+	return frame;
+}
+
+double FrameUploadRing::getLastStallMs() const
+{
+	return lastStallMs;
+}
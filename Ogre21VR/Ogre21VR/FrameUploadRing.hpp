@@ -0,0 +1,58 @@
+#pragma once
+#include <Windows.h>
+
+//OpenGL extension loading
+#include <GL/gl3w.h>
+
+//C++ standard libraries
+#include <vector>
+
+///Uniform data written by the CPU once per frame, straight into a persistently mapped buffer.
+///The buffer is split in one region per frame in flight, and a region is only reused once its fence is signaled
+class FrameUploadRing
+{
+public:
+	///A range of the ring, valid until the end of the frame it was allocated in
+	struct Allocation
+	{
+		void* data;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	///Create and map the buffer. "bytesPerFrame" is the most that can be allocated in a single frame
+	FrameUploadRing(size_t bytesPerFrame, size_t frameCount = 3);
+	///Unmap and delete the buffer
+	~FrameUploadRing();
+
+	///Move to the next region, waiting for the GPU to be done with it if needed
+	void beginFrame();
+	///Fence the region used by this frame
+	void endFrame();
+
+	///Get "size" bytes to write to, aligned for uniform buffer and buffer texture bindings. Throw if the frame region is full
+	Allocation allocate(size_t size);
+	///Bind an allocation as the uniform buffer "binding"
+	void bind(GLuint binding, const Allocation& allocation) const;
+	///Bind an allocation as the content of a buffer texture on texture unit "unit". The active texture unit is left untouched
+	void bindTexture(GLuint unit, GLuint texture, GLenum internalFormat, const Allocation& allocation) const;
+
+	///Size of the whole buffer, all the frame regions included
+	size_t getCapacity() const;
+	///Number of frames begun since the creation of the ring
+	size_t getFrame() const;
+	///Time spent waiting on fences in the last beginFrame, in milliseconds. Should stay at 0
+	double getLastStallMs() const;
+
+private:
+	GLuint buffer;
+	GLubyte* mapped;
+	size_t regionSize;
+	size_t alignment;
+
+	std::vector<GLsync> fences;
+	size_t region;
+	size_t head;
+	size_t frame;
+	double lastStallMs;
+};
@@ -1,7 +0,0 @@
-@piece( SetCrossPlatformSettings )
-@property( GL430 )#version 430 core
-@end @property( !GL430 )
-#version 330 core
-#extension GL_ARB_shading_language_420pack: require
-@end
-@end
@@ -1,26 +0,0 @@
-@piece( Common_Matrix_DeclUnpackMatrix4x4 )
-mat4 UNPACK_MAT4( samplerBuffer matrixBuf, uint pixelIdx )
-{
-        vec4 row0 = texelFetch( matrixBuf, int((pixelIdx) << 2u) );
-        vec4 row1 = texelFetch( matrixBuf, int(((pixelIdx) << 2u) + 1u) );
-        vec4 row2 = texelFetch( matrixBuf, int(((pixelIdx) << 2u) + 2u) );
-        vec4 row3 = texelFetch( matrixBuf, int(((pixelIdx) << 2u) + 3u) );
-    return mat4( row0.x, row1.x, row2.x, row3.x,
-                 row0.y, row1.y, row2.y, row3.y,
-                 row0.z, row1.z, row2.z, row3.z,
-                 row0.w, row1.w, row2.w, row3.w );
-}
-@end
-
-@piece( Common_Matrix_DeclUnpackMatrix4x3 )
-mat4x3 UNPACK_MAT4x3( samplerBuffer matrixBuf, uint pixelIdx )
-{
-        vec4 row0 = texelFetch( matrixBuf, int((pixelIdx) << 2u) );
-        vec4 row1 = texelFetch( matrixBuf, int(((pixelIdx) << 2u) + 1u) );
-        vec4 row2 = texelFetch( matrixBuf, int(((pixelIdx) << 2u) + 2u) );
-        return mat4x3( row0.x, row1.x, row2.x,
-                       row0.y, row1.y, row2.y,
-                       row0.z, row1.z, row2.z,
-                       row0.w, row1.w, row2.w );
-}
-@end
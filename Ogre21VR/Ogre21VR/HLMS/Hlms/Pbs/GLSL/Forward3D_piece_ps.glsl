@@ -14,8 +14,11 @@
 	fSlice = floor( fSlice * f3dNumSlicesSub1 );
 	uint slice = uint( fSlice );
 
-	//TODO: Profile performance: derive this mathematically or use a lookup table?
+@property( vr_f3d_slice_table )
+	uint offset = pass.f3dSliceOffsets[slice >> 2u][slice & 3u];
+@end @property( !vr_f3d_slice_table )
 	uint offset = cellsPerTableOnGrid0 * (((1u << (slice << 1u)) - 1u) / 3u);
+@end
 
 	float lightsPerCell = pass.f3dGridHWW[0].w;
 
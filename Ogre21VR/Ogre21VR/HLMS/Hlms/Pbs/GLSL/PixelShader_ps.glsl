@@ -44,6 +44,9 @@ in block
 @property( hlms_forward3d )
 /*layout(binding = 1) */uniform usamplerBuffer f3dGrid;
 /*layout(binding = 2) */uniform samplerBuffer f3dLightList;@end
+@property( vr_stereo_grid )
+layout(binding = @value( vr_stereo_grid_cells_unit )) uniform usamplerBuffer vrGridCells;
+layout(binding = @value( vr_stereo_grid_lights_unit )) uniform samplerBuffer vrGridLights;@end
 @property( !roughness_map )#define ROUGHNESS material.kS.w@end
 @property( num_textures )uniform sampler2DArray textureMaps[@value( num_textures )];@end
 @property( envprobe_map )uniform samplerCube	texEnvProbeMap;@end
@@ -347,7 +350,7 @@ void main()
 @end
 
 	//Everything's in Camera space
-@property( hlms_lights_spot || ambient_hemisphere || envprobe_map || hlms_forward3d )
+@property( hlms_lights_spot || ambient_hemisphere || envprobe_map || hlms_forward3d || vr_stereo_grid )
 	vec3 viewDir	= normalize( -inPs.pos );
 	float NdotV		= clamp( dot( nNormal, viewDir ), 0.0, 1.0 );@end
 
@@ -412,6 +415,7 @@ void main()
 	}@end
 
 @insertpiece( forward3dLighting )
+@insertpiece( stereoGridLighting )
 
 @property( envprobe_map || ambient_hemisphere )
 	vec3 reflDir = 2.0 * dot( viewDir, nNormal ) * nNormal - viewDir;
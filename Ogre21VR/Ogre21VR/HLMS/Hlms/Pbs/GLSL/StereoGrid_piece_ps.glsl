@@ -0,0 +1,73 @@
+@property( vr_stereo_grid )
+@piece( stereoGridLighting )
+	//The grid is shared by both eyes : it's in head space, not in the view space of this eye
+	vec3 gridPos = (eyePass.gridFromView * vec4( inPs.pos, 1.0 )).xyz;
+
+	//See C++'s StereoLightGrid::execute. The apex of the grid is eyePass.gridSize.z behind the head
+	float gridDepth = eyePass.gridSize.z - gridPos.z;
+	vec2 gridCell = clamp( floor( (gridPos.xy / gridDepth) * eyePass.gridProjection.xz + eyePass.gridProjection.yw ),
+						   vec2( 0.0, 0.0 ), eyePass.gridSize.xy - 1.0 );
+	float gridT = clamp( (gridDepth - eyePass.gridDepth.x) * eyePass.gridDepth.y, 0.0, 1.0 );
+@property( vr_stereo_grid_exponential )
+	//1 - (1 - t)^8 : thin slices close to the eyes
+	gridT = 1.0 - gridT;
+	gridT *= gridT;
+	gridT *= gridT;
+	gridT = 1.0 - gridT * gridT;
+@end
+	float gridSlice = floor( gridT * eyePass.gridDepth.z );
+
+	uint gridCellStride = uint( eyePass.gridDepth.w ) + 1u;
+	uint gridOffset = ((uint( gridSlice ) * uint( eyePass.gridSize.y ) + uint( gridCell.y )) * uint( eyePass.gridSize.x ) +
+					   uint( gridCell.x )) * gridCellStride;
+
+	uint numGridLights = texelFetch( vrGridCells, int(gridOffset) ).x;
+
+	for( uint i=0u; i<numGridLights; ++i )
+	{
+		//Offset of the light in the light list
+		uint idx = texelFetch( vrGridCells, int(gridOffset + i + 1u) ).x;
+
+		vec4 posAndType = texelFetch( vrGridLights, int(idx) );
+
+		vec3 lightDiffuse	= texelFetch( vrGridLights, int(idx + 1u) ).xyz;
+		vec3 lightSpecular	= texelFetch( vrGridLights, int(idx + 2u) ).xyz;
+		vec4 attenuation	= texelFetch( vrGridLights, int(idx + 3u) ).xyzw;
+
+		//Back to the eye space, where the BRDF inputs are. gridFromView is rigid, so its inverse rotation is its transpose
+		vec3 lightDir	= (posAndType.xyz - gridPos) * mat3( eyePass.gridFromView );
+		float fDistance	= length( lightDir );
+
+		if( fDistance <= attenuation.x )
+		{
+			lightDir *= 1.0 / fDistance;
+			float atten = 1.0 / (1.0 + (attenuation.y + attenuation.z * fDistance) * fDistance );
+
+			if( posAndType.w == 1.0 )
+			{
+				//Point light
+				vec3 tmpColour = BRDF( lightDir, viewDir, NdotV, lightDiffuse, lightSpecular );
+				finalColour += tmpColour * atten;
+			}
+			else
+			{
+				//Spot light. Both the direction and the position are in grid space
+				vec3 spotDirection	= texelFetch( vrGridLights, int(idx + 4u) ).xyz;
+				vec3 spotParams		= texelFetch( vrGridLights, int(idx + 5u) ).xyz;
+
+				float spotCosAngle = dot( normalize( gridPos - posAndType.xyz ), spotDirection.xyz );
+
+				float spotAtten = clamp( (spotCosAngle - spotParams.y) * spotParams.x, 0.0, 1.0 );
+				spotAtten = pow( spotAtten, spotParams.z );
+				atten *= spotAtten;
+
+				if( spotCosAngle >= spotParams.y )
+				{
+					vec3 tmpColour = BRDF( lightDir, viewDir, NdotV, lightDiffuse, lightSpecular );
+					finalColour += tmpColour * atten;
+				}
+			}
+		}
+	}
+@end
+@end
@@ -57,9 +57,24 @@ layout(binding = 0) uniform PassBuffer
 	//f3dData.w = uint cellsPerTableOnGrid0 (floatBitsToUint);
 	vec4 f3dData;
 	vec4 f3dGridHWW[@value( hlms_forward3d )];
+@end
+@property( vr_f3d_slice_table )
+	//Cell offset of each Forward3D slice, 4 per uvec4. Written by StereoPassListener
+	uvec4 f3dSliceOffsets[@value( vr_f3d_slice_table )];
 @end
 	@insertpiece( custom_passBuffer )
 } pass;
+
+@property( vr_stereo_grid )
+//Stereo light grid of the pass, uploaded once per frame for both eyes by the renderer (see StereoPassListener and StereoLightGrid)
+layout(binding = 4) uniform EyePassBuffer
+{
+	mat4 gridFromView;
+	vec4 gridProjection;
+	vec4 gridDepth;
+	vec4 gridSize;
+} eyePass;
+@end
 @end
 
 @property( fresnel_scalar )@piece( FresnelType )vec3@end @piece( FresnelSwizzle )xyz@end @end
@@ -0,0 +1,12 @@
+@property( vr_octahedral_normal )
+@piece( DeclOctahedralDecode )
+//See C++'s VertexCompressor : the normal is folded on an octahedron, then unfolded on the xy plane
+vec3 octahedralDecode( vec2 encoded )
+{
+	vec3 n = vec3( encoded.xy, 1.0 - abs( encoded.x ) - abs( encoded.y ) );
+	if( n.z < 0.0 )
+		n.xy = (1.0 - abs( n.yx )) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );
+	return normalize( n );
+}
+@end
+@end
@@ -12,7 +12,8 @@ layout(std140) uniform;
 
 in vec4 vertex;
 
-@property( hlms_normal )in vec3 normal;@end
+@property( hlms_normal && !vr_octahedral_normal )in vec3 normal;@end
+@property( vr_octahedral_normal )in vec2 normal;@end
 @property( hlms_qtangent )in vec4 qtangent;@end
 
 @property( normal_map && !hlms_qtangent )
@@ -45,6 +46,8 @@ layout(binding = 0) uniform samplerBuffer worldMatBuf;
 @insertpiece( custom_vs_uniformDeclaration )
 // END UNIFORM DECLARATION
 
+@insertpiece( DeclOctahedralDecode )
+
 @property( hlms_qtangent )
 @insertpiece( DeclQuat_xAxis )
 @property( normal_map )
@@ -154,6 +157,11 @@ void main()
     vec4 worldPos = vec4( (worldMat * vertex).xyz, 1.0f );
 @end
 
+@property( vr_octahedral_normal )
+	//Declared after its initialiser, so it hides the vec2 attribute from here on
+	vec3 normal = octahedralDecode( normal );
+@end
+
 @property( hlms_qtangent )
 	//Decode qTangent to TBN with reflection
 	vec3 normal		= xAxis( normalize( qtangent ) );
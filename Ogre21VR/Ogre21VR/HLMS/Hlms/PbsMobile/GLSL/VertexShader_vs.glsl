@@ -4,7 +4,8 @@
 
 in vec4 vertex;
 
-@property( hlms_normal )in vec3 normal;@end
+@property( hlms_normal && !vr_octahedral_normal )in vec3 normal;@end
+@property( vr_octahedral_normal )in vec2 normal;@end
 @property( hlms_qtangent )in vec4 normal;@end
 
 @property( normal_map && !hlms_qtangent )
@@ -23,6 +24,17 @@ in vec4 blendWeights;@end
 
 @property( hlms_shadowcaster || hlms_pssm_splits )out float psDepth;@end
 
+@property( vr_octahedral_normal )
+//Same as the desktop tier's VertexDecode piece, which this tier's library doesn't have
+vec3 octahedralDecode( vec2 encoded )
+{
+	vec3 n = vec3( encoded.xy, 1.0 - abs( encoded.x ) - abs( encoded.y ) );
+	if( n.z < 0.0 )
+		n.xy = (1.0 - abs( n.yx )) * vec2( n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0 );
+	return normalize( n );
+}
+@end
+
 @foreach( hlms_uv_count, n )
 in vec@value( hlms_uv_count@n ) uv@n;@end
 @foreach( hlms_uv_count, n )
@@ -124,6 +136,10 @@ uniform mat4 worldViewProj;
 
 void main()
 {
+@property( vr_octahedral_normal )
+	//Declared after its initialiser, so it hides the vec2 attribute from here on
+	vec3 normal = octahedralDecode( normal );
+@end
 	@insertpiece( SkeletonTransform )
 	@insertpiece( VertexTransform )
 @foreach( hlms_uv_count, n )
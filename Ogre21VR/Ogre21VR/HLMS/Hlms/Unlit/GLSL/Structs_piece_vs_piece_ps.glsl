@@ -7,6 +7,10 @@ layout(binding = 0) uniform PassBuffer
 	@property( hlms_shadowcaster )
 		vec4 depthRange;
 	@end
+	@property( vr_f3d_slice_table )
+		//Written for every HLMS by StereoPassListener, even if Unlit doesn't use it
+		uvec4 f3dSliceOffsets[@value( vr_f3d_slice_table )];
+	@end
 	@insertpiece( custom_passBuffer )
 } pass;
 @end
@@ -0,0 +1,282 @@
+#include "HiddenAreaMesh.hpp"
+
+#include <OGRE/Compositor/OgreCompositorChannel.h>
+#include <OGRE/Compositor/OgreCompositorNode.h>
+#include <OGRE/Compositor/OgreCompositorWorkspace.h>
+#include <OGRE/Compositor/OgreCompositorWorkspaceListener.h>
+#include <OGRE/Compositor/Pass/OgreCompositorPass.h>
+#include <OGRE/Compositor/Pass/OgreCompositorPassDef.h>
+
+namespace
+{
+	//The attribute is the UV of the whole eye buffer, v down
+	const char* const vertexShader{ R"(#version 330 core
+layout( location = 0 ) in vec2 uv;
+uniform float flipY;
+uniform float depth;
+void main()
+{
+	gl_Position = vec4( uv.x * 2.0 - 1.0, (1.0 - uv.y * 2.0) * flipY, depth, 1.0 );
+}
+)" };
+
+	//Only the depth is written, or zeroes over a colour target
+	const char* const fragmentShader{ R"(#version 330 core
+out vec4 colour;
+void main()
+{
+	colour = vec4( 0.0 );
+}
+)" };
+
+	GLuint compileShader(GLenum type, const char* source)
+	{
+		const auto shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, nullptr);
+		glCompileShader(shader);
+
+		GLint compiled;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+		if (!compiled) throw std::runtime_error("Cannot compile the hidden area mesh shaders");
+		return shader;
+	}
+
+	class HiddenAreaPassDef : public Ogre::CompositorPassDef
+	{
+	public:
+		explicit HiddenAreaPassDef(Ogre::CompositorTargetDef* parentTargetDef) :
+			Ogre::CompositorPassDef(Ogre::PASS_CUSTOM, parentTargetDef),
+			mColour{ false }
+		{
+		}
+
+		///Zero the colour under the mesh instead of writing its depth
+		bool mColour;
+	};
+
+	class HiddenAreaPass : public Ogre::CompositorPass
+	{
+	public:
+		HiddenAreaPass(const HiddenAreaMesh& mesh, const Ogre::CompositorPassDef* definition, const Ogre::CompositorChannel& target, Ogre::CompositorNode* parentNode) :
+			Ogre::CompositorPass(definition, target, parentNode),
+			mesh(mesh),
+			colour{ static_cast<const HiddenAreaPassDef*>(definition)->mColour }
+		{
+		}
+
+		void execute(const Ogre::Camera*) override
+		{
+			//The workspace listener sees this pass like Ogre's own ones : the clip range is set there with reverse depth
+			auto listener = mParentNode->getWorkspace()->getListener();
+			if (listener) listener->passEarlyPreExecute(this);
+
+			executeResourceTransitions();
+
+			//Binds the target and its viewport, the whole texture, in Ogre's state cache too
+			Ogre::Root::getSingleton().getRenderSystem()->_setViewport(mViewport);
+			if (listener) listener->passPreExecute(this);
+			mesh.draw(mTarget->requiresTextureFlipping(), colour);
+		}
+
+	private:
+		const HiddenAreaMesh& mesh;
+		const bool colour;
+	};
+
+	class HiddenAreaPassProvider : public Ogre::CompositorPassProvider
+	{
+	public:
+		explicit HiddenAreaPassProvider(const HiddenAreaMesh& mesh) :
+			mesh(mesh)
+		{
+		}
+
+		Ogre::CompositorPassDef* addPassDef(Ogre::CompositorPassType, Ogre::IdString customId,
+											Ogre::CompositorTargetDef* parentTargetDef, Ogre::CompositorNodeDef*) override
+		{
+			if (customId != Ogre::IdString(HiddenAreaMesh::passId)) return nullptr;
+			return OGRE_NEW HiddenAreaPassDef(parentTargetDef);
+		}
+
+		Ogre::CompositorPass* addPass(const Ogre::CompositorPassDef* definition, Ogre::Camera*, Ogre::CompositorNode* parentNode,
+									  const Ogre::CompositorChannel& target, Ogre::SceneManager*) override
+		{
+			return OGRE_NEW HiddenAreaPass(mesh, definition, target, parentNode);
+		}
+
+	private:
+		const HiddenAreaMesh& mesh;
+	};
+}
+
+constexpr const char* const HiddenAreaMesh::passId;
+
+HiddenAreaMesh::HiddenAreaMesh() :
+	program{ glCreateProgram() },
+	vertexArray{ 0 },
+	vertexBuffer{ 0 },
+	vertexCount{ 0 },
+	reverseDepth{ false },
+	passProvider{ std::make_unique<HiddenAreaPassProvider>(*this) }
+{
+	const auto vertex = compileShader(GL_VERTEX_SHADER, vertexShader);
+	const auto fragment = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	glLinkProgram(program);
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+
+	GLint linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (!linked) throw std::runtime_error("Cannot link the hidden area mesh program");
+	flipYLocation = glGetUniformLocation(program, "flipY");
+	depthLocation = glGetUniformLocation(program, "depth");
+
+	glGenVertexArrays(1, &vertexArray);
+	glGenBuffers(1, &vertexBuffer);
+}
+
+HiddenAreaMesh::~HiddenAreaMesh()
+{
+	glDeleteBuffers(1, &vertexBuffer);
+	glDeleteVertexArrays(1, &vertexArray);
+	glDeleteProgram(program);
+}
+
+std::vector<Ogre::Vector2> HiddenAreaMesh::generate(const VREyeFov& fov, float radius, size_t segmentsPerCorner)
+{
+	std::vector<Ogre::Vector2> triangles;
+
+	//The ellipse contains the whole viewport
+	if (radius >= Ogre::Math::Sqrt(2)) return triangles;
+
+	//From -1 to 1 between the edges of the viewport, centered on the center of projection, y up. To UV, v down
+	const auto toUv = [&fov](const Ogre::Vector2& point)
+	{
+		const auto x = Ogre::Math::Clamp<Ogre::Real>(point.x, -1, 1);
+		const auto y = Ogre::Math::Clamp<Ogre::Real>(point.y, -1, 1);
+		const auto tangentX = x * (x < 0 ? fov.left : fov.right);
+		const auto tangentY = y * (y > 0 ? fov.up : fov.down);
+		return Ogre::Vector2{ (tangentX + fov.left) / (fov.left + fov.right), (fov.up - tangentY) / (fov.up + fov.down) };
+	};
+
+	//A fan from each corner to the quarter of the ellipse in front of it, and to the edges around it.
+	//When the ellipse goes past an edge, the points clamped on it make flat triangles
+	for (const auto& corner : { Ogre::Vector2{ 1, 1 }, Ogre::Vector2{ -1, 1 }, Ogre::Vector2{ -1, -1 }, Ogre::Vector2{ 1, -1 } })
+	{
+		std::vector<Ogre::Vector2> outline{ { corner.x, 0 } };
+		for (size_t i{ 0 }; i <= segmentsPerCorner; ++i)
+		{
+			const auto angle = Ogre::Math::HALF_PI * Ogre::Real(i) / Ogre::Real(segmentsPerCorner);
+			outline.emplace_back(corner.x * radius * std::cos(angle), corner.y * radius * std::sin(angle));
+		}
+		outline.emplace_back(0, corner.y);
+
+		for (size_t i{ 1 }; i < outline.size(); ++i)
+		{
+			triangles.push_back(toUv(corner));
+			triangles.push_back(toUv(outline[i - 1]));
+			triangles.push_back(toUv(outline[i]));
+		}
+	}
+
+	return triangles;
+}
+
+void HiddenAreaMesh::setTriangles(size_t eye, const std::vector<Ogre::Vector2>& triangles)
+{
+	eyeTriangles[eye] = triangles;
+	upload();
+}
+
+void HiddenAreaMesh::setReverseDepth(bool enabled)
+{
+	reverseDepth = enabled;
+}
+
+size_t HiddenAreaMesh::getTriangleCount() const
+{
+	return size_t(vertexCount) / 3;
+}
+
+Ogre::CompositorPassProvider* HiddenAreaMesh::getPassProvider()
+{
+	return passProvider.get();
+}
+
+void HiddenAreaMesh::addPass(Ogre::CompositorTargetDef* targetDef, bool colour)
+{
+	static_cast<HiddenAreaPassDef*>(targetDef->addPass(Ogre::PASS_CUSTOM, passId))->mColour = colour;
+}
+
+void HiddenAreaMesh::upload()
+{
+	//Each eye is a half of the eye buffer
+	std::vector<float> vertices;
+	for (size_t eye{ 0 }; eye < eyeTriangles.size(); ++eye)
+		for (const auto& uv : eyeTriangles[eye])
+		{
+			vertices.push_back((float(eye) + uv.x) / 2);
+			vertices.push_back(uv.y);
+		}
+	vertexCount = GLsizei(vertices.size() / 2);
+
+	//Ogre caches the bound vertex array and buffer, put them back
+	GLint previousVertexArray, previousBuffer;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousBuffer);
+
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+	glBindVertexArray(GLuint(previousVertexArray));
+	glBindBuffer(GL_ARRAY_BUFFER, GLuint(previousBuffer));
+}
+
+void HiddenAreaMesh::draw(bool flipY, bool colour) const
+{
+	if (!vertexCount) return;
+
+	//Ogre caches the GL state it sets : everything touched here is put back as it was
+	GLint previousProgram, previousVertexArray, previousDepthFunc;
+	GLboolean depthTest, cullFace, blend, depthMask, colorMask[4];
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+	glGetIntegerv(GL_DEPTH_FUNC, &previousDepthFunc);
+	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+	glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+	depthTest = glIsEnabled(GL_DEPTH_TEST);
+	cullFace = glIsEnabled(GL_CULL_FACE);
+	blend = glIsEnabled(GL_BLEND);
+
+	//Depth writes need the depth test on. Over a colour target, the colour is written instead
+	const GLboolean writeColour{ colour ? GLboolean(GL_TRUE) : GLboolean(GL_FALSE) };
+	if (colour) glDisable(GL_DEPTH_TEST);
+	else glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_ALWAYS);
+	glDepthMask(colour ? GL_FALSE : GL_TRUE);
+	glColorMask(writeColour, writeColour, writeColour, writeColour);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_BLEND);
+
+	//The near plane is at -1 in clip space, 1 with the reversed [0; 1] clip range
+	glUseProgram(program);
+	glUniform1f(flipYLocation, flipY ? -1.0f : 1.0f);
+	glUniform1f(depthLocation, reverseDepth ? 1.0f : -1.0f);
+	glBindVertexArray(vertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+	glBindVertexArray(GLuint(previousVertexArray));
+	glUseProgram(GLuint(previousProgram));
+	glColorMask(colorMask[0], colorMask[1], colorMask[2], colorMask[3]);
+	glDepthMask(depthMask);
+	glDepthFunc(GLenum(previousDepthFunc));
+	if (depthTest) glEnable(GL_DEPTH_TEST);
+	else glDisable(GL_DEPTH_TEST);
+	if (cullFace) glEnable(GL_CULL_FACE);
+	if (blend) glEnable(GL_BLEND);
+}
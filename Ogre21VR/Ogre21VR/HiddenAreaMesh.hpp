@@ -0,0 +1,62 @@
+#pragma once
+#include <Windows.h>
+
+//OpenGL extension loading
+#include <GL/gl3w.h>
+
+//C++ standard libraries
+#include <array>
+#include <memory>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/Compositor/OgreCompositorNodeDef.h>
+#include <OGRE/Compositor/Pass/OgreCompositorPassProvider.h>
+
+#include "RadialDensityMask.hpp"
+
+///The parts of the eye buffers the lenses never show, written to the depth buffer at the near plane before the scene passes.
+///Every pixel of the scene there fails the depth test before its pixel shader runs. Both eyes are drawn in one call
+class HiddenAreaMesh
+{
+public:
+	///Custom pass id of the pass drawing the mesh
+	static constexpr const char* const passId{ "VRHiddenArea" };
+
+	///Create the GL objects. Needs the GL context
+	HiddenAreaMesh();
+	///Destroy the GL objects. Has to happen while the context is alive
+	~HiddenAreaMesh();
+	HiddenAreaMesh(const HiddenAreaMesh&) = delete;
+	HiddenAreaMesh& operator=(const HiddenAreaMesh&) = delete;
+
+	///Triangles hiding the area outside an ellipse of "radius" around the center of projection, 1 touching the edges of the viewport.
+	///For the runtimes that don't give their mesh. In eye buffer UV, v down, 3 points per triangle
+	static std::vector<Ogre::Vector2> generate(const VREyeFov& fov, float radius, size_t segmentsPerCorner = 8);
+	///Set the triangles of an eye, in the UV of its half of the eye buffer, v down. 3 points per triangle
+	void setTriangles(size_t eye, const std::vector<Ogre::Vector2>& triangles);
+	///Write the near plane depth of a reversed depth buffer
+	void setReverseDepth(bool enabled);
+	size_t getTriangleCount() const;
+
+	///Give the custom pass to the compositor manager. Needed before a node definition uses addPass
+	Ogre::CompositorPassProvider* getPassProvider();
+	///Add the pass drawing the mesh to an eye buffer target, after its clear pass.
+	///With "colour", it zeroes the colour of a target covering the eye buffer instead, to mask out what the lenses don't show
+	static void addPass(Ogre::CompositorTargetDef* targetDef, bool colour = false);
+
+	///Draw both eyes into the bound target. Leaves the GL state as Ogre expects it. "flipY" for render textures
+	void draw(bool flipY, bool colour = false) const;
+
+private:
+	///Upload the triangles of both eyes, in the clip space of the whole eye buffer
+	void upload();
+
+	std::array<std::vector<Ogre::Vector2>, 2> eyeTriangles;
+	GLuint program, vertexArray, vertexBuffer;
+	GLint flipYLocation, depthLocation;
+	GLsizei vertexCount;
+	bool reverseDepth;
+	std::unique_ptr<Ogre::CompositorPassProvider> passProvider;
+};
@@ -0,0 +1,128 @@
+#include "HlmsHotReloader.hpp"
+
+#include <algorithm>
+
+#include "FrameArena.hpp"
+
+constexpr std::chrono::milliseconds HlmsHotReloader::settleTime;
+
+HlmsHotReloader::HlmsHotReloader(Ogre::HlmsManager* hlmsManager, std::chrono::milliseconds pollPeriod) :
+	pollPeriod{ pollPeriod },
+	running{ true }
+{
+	for (int type{ 0 }; type < Ogre::HLMS_MAX; ++type)
+	{
+		const auto hlms = hlmsManager->getHlms(Ogre::HlmsTypes(type));
+		if (!hlms || !hlms->getDataFolder()) continue;
+
+		addFolder(hlms->getDataFolder(), hlms);
+		for (auto library : hlms->getPiecesLibraryAsArchiveVec())
+			addFolder(library, hlms);
+	}
+
+	//First snapshot here, so only the changes made from now on count
+	for (auto& folder : folders)
+		scan(folder);
+	changedFolders.assign(folders.size(), false);
+
+	Ogre::LogManager::getSingleton().logMessage("HLMS hot reload : watching " + std::to_string(folders.size()) + " template folders");
+	watcher = std::thread{ [this] { watch(); } };
+}
+
+HlmsHotReloader::~HlmsHotReloader()
+{
+	running = false;
+	wakeUp.notify_all();
+	watcher.join();
+}
+
+void HlmsHotReloader::addFolder(Ogre::Archive* archive, Ogre::Hlms* hlms)
+{
+	if (archive->getType() != "FileSystem") return;
+
+	//The common library is shared by all the HLMS
+	auto folder = std::find_if(folders.begin(), folders.end(), [archive](const WatchedFolder& watched) { return watched.path == archive->getName(); });
+	if (folder == folders.end())
+	{
+		folders.push_back({ archive->getName(), {}, {} });
+		folder = folders.end() - 1;
+	}
+	if (std::find(folder->users.begin(), folder->users.end(), hlms) == folder->users.end())
+		folder->users.push_back(hlms);
+}
+
+bool HlmsHotReloader::scan(WatchedFolder& folder)
+{
+	std::map<std::string, std::pair<ULONGLONG, ULONGLONG>> files;
+
+	WIN32_FIND_DATAA findData;
+	const auto search = FindFirstFileA((folder.path + "/*").c_str(), &findData);
+	if (search != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+			const auto writeTime = (ULONGLONG(findData.ftLastWriteTime.dwHighDateTime) << 32) | findData.ftLastWriteTime.dwLowDateTime;
+			const auto size = (ULONGLONG(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+			files[findData.cFileName] = { writeTime, size };
+		} while (FindNextFileA(search, &findData));
+		FindClose(search);
+	}
+
+	//Added and removed files count too : a new piece file changes what the HLMS enumerates
+	const auto changed = files != folder.files;
+	folder.files = std::move(files);
+	return changed;
+}
+
+void HlmsHotReloader::watch()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (running)
+	{
+		wakeUp.wait_for(lock, pollPeriod, [this] { return !running; });
+		if (!running) break;
+
+		//Scanning hits the disk, the render thread must not wait on that
+		lock.unlock();
+		std::vector<size_t> changed;
+		for (size_t i{ 0 }; i < folders.size(); ++i)
+			if (scan(folders[i]))
+				changed.push_back(i);
+		lock.lock();
+
+		for (auto i : changed)
+			changedFolders[i] = true;
+		if (!changed.empty())
+			lastChange = std::chrono::steady_clock::now();
+	}
+}
+
+size_t HlmsHotReloader::update()
+{
+	//Gather the HLMS to reload under the lock, reload them without it. This runs every frame : no heap allocation
+	ScratchScope scratch;
+	auto toReload = scratch.makeVector<Ogre::Hlms*>();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (std::chrono::steady_clock::now() - lastChange < settleTime) return 0;
+
+		for (size_t i{ 0 }; i < folders.size(); ++i)
+			if (changedFolders[i])
+			{
+				toReload.insert(toReload.end(), folders[i].users.begin(), folders[i].users.end());
+				changedFolders[i] = false;
+			}
+	}
+	std::sort(toReload.begin(), toReload.end());
+	toReload.erase(std::unique(toReload.begin(), toReload.end()), toReload.end());
+
+	//reloadFrom clears the shader cache and enumerates the pieces again. The datablocks and the renderables stay as they are
+	for (auto hlms : toReload)
+	{
+		hlms->reloadFrom(hlms->getDataFolder());
+		Ogre::LogManager::getSingleton().logMessage("HLMS hot reload : reloaded " + hlms->getTypeNameStr());
+	}
+
+	return toReload.size();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <Windows.h>
+
+//C++ standard libraries
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreHlms.h>
+#include <OGRE/OgreHlmsManager.h>
+
+///Watch the template folders of the registered HLMS on a background thread, and reload the HLMS using a folder that changed.
+///Only loose "FileSystem" folders are watched : a .hlmspack is mapped, it can't be rebuilt while the application runs
+class HlmsHotReloader
+{
+public:
+	///Watch the folders of every HLMS registered at this point. Declare the HLMS library first
+	explicit HlmsHotReloader(Ogre::HlmsManager* hlmsManager, std::chrono::milliseconds pollPeriod = std::chrono::milliseconds{ 250 });
+	~HlmsHotReloader();
+
+	///Reload the HLMS whose templates changed. Call it on the render thread, between two frames, so a frame never mixes old
+	///and new shaders. The changed permutations are compiled again when the next frame needs them. Return the number of HLMS reloaded
+	size_t update();
+
+private:
+	///A template folder, and the HLMS to reload when it changes
+	struct WatchedFolder
+	{
+		Ogre::String path;
+		std::vector<Ogre::Hlms*> users;
+		///Last write time and size of each file. Only touched by the watcher thread
+		std::map<std::string, std::pair<ULONGLONG, ULONGLONG>> files;
+	};
+
+	///Add "hlms" as a user of that folder
+	void addFolder(Ogre::Archive* archive, Ogre::Hlms* hlms);
+	///Snapshot the files of a folder. Return true if it differs from the last one
+	static bool scan(WatchedFolder& folder);
+	///Body of the watcher thread
+	void watch();
+
+	std::vector<WatchedFolder> folders;
+	const std::chrono::milliseconds pollPeriod;
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::atomic<bool> running;
+	///Guarded by the mutex. Folders changed since the last reload, and when the last change was seen
+	std::vector<bool> changedFolders;
+	std::chrono::steady_clock::time_point lastChange;
+	std::thread watcher;
+
+	///Editors often write a file several times when saving. Wait for the folder to settle before reloading
+	static constexpr std::chrono::milliseconds settleTime{ 200 };
+};
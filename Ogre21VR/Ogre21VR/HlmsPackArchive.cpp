@@ -0,0 +1,257 @@
+#include "HlmsPackArchive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+
+constexpr const char* const HlmsPackArchive::type;
+constexpr char HlmsPackArchive::separator;
+
+//Layout of a pack, little endian, as PackHlms.ps1 writes it :
+//  PackHeader
+//  PackEntry * entryCount, sorted by name
+//  names, then the content of the templates. Offsets are from the start of the file
+namespace
+{
+	const char packMagic[4]{ 'H', 'L', 'M', 'P' };
+	const uint32_t packVersion{ 1 };
+
+	struct PackHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+	};
+
+	struct PackEntry
+	{
+		uint32_t nameOffset, nameLength;
+		uint32_t dataOffset, dataLength;
+	};
+}
+
+///A .hlmspack file mapped in memory. Shared by all the archives opened on it
+class HlmsPackFile
+{
+public:
+	///Map the pack, or return the already mapped one
+	static std::shared_ptr<HlmsPackFile> open(const std::string& path)
+	{
+		static std::mutex mutex;
+		static std::map<std::string, std::weak_ptr<HlmsPackFile>> openedPacks;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& opened = openedPacks[path];
+		auto pack = opened.lock();
+		if (!pack)
+		{
+			pack = std::make_shared<HlmsPackFile>(path);
+			opened = pack;
+		}
+		return pack;
+	}
+
+	explicit HlmsPackFile(const std::string& path) :
+		file{ INVALID_HANDLE_VALUE },
+		mapping{ nullptr },
+		view{ nullptr },
+		size{ 0 },
+		modifiedTime{ 0 }
+	{
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("Cannot open the HLMS pack " + path);
+
+		LARGE_INTEGER fileSize;
+		GetFileSizeEx(file, &fileSize);
+		size = size_t(fileSize.QuadPart);
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!view || size < sizeof(PackHeader) || std::memcmp(header().magic, packMagic, sizeof packMagic) || header().version != packVersion)
+		{
+			close();
+			throw std::runtime_error(path + " is not an HLMS pack, or was made by another version. Build the project again to pack the templates");
+		}
+
+		struct _stat fileStat;
+		if (_stat(path.c_str(), &fileStat) == 0) modifiedTime = fileStat.st_mtime;
+	}
+
+	~HlmsPackFile()
+	{
+		close();
+	}
+
+	const PackHeader& header() const
+	{
+		return *reinterpret_cast<const PackHeader*>(view);
+	}
+
+	const PackEntry* entries() const
+	{
+		return reinterpret_cast<const PackEntry*>(view + sizeof(PackHeader));
+	}
+
+	const char* at(uint32_t offset, uint32_t length) const
+	{
+		if (size_t(offset) + length > size) throw std::runtime_error("Truncated HLMS pack");
+		return view + offset;
+	}
+
+	time_t getModifiedTime() const
+	{
+		return modifiedTime;
+	}
+
+private:
+	void close()
+	{
+		if (view) UnmapViewOfFile(view);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		view = nullptr;
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+	}
+
+	HANDLE file;
+	HANDLE mapping;
+	const char* view;
+	size_t size;
+	time_t modifiedTime;
+};
+
+HlmsPackArchive::HlmsPackArchive(const Ogre::String& name, const Ogre::String& archiveType) :
+	Archive(name, archiveType)
+{
+}
+
+HlmsPackArchive::~HlmsPackArchive()
+{
+	unload();
+}
+
+bool HlmsPackArchive::isCaseSensitive() const
+{
+	return true;
+}
+
+void HlmsPackArchive::load()
+{
+	const auto separatorPosition = mName.find(separator);
+	if (separatorPosition == Ogre::String::npos)
+		throw std::runtime_error("HLMS pack archive names are \"pack" + Ogre::String(1, separator) + "folder\", not " + mName);
+
+	pack = HlmsPackFile::open(mName.substr(0, separatorPosition));
+	auto prefix = mName.substr(separatorPosition + 1);
+	if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+	//The pack is sorted, so the entries of the folder are too
+	entries.clear();
+	const auto packEntries = pack->entries();
+	const auto entryCount = pack->header().entryCount;
+	pack->at(sizeof(PackHeader), entryCount * sizeof(PackEntry));
+	for (uint32_t i{ 0 }; i < entryCount; ++i)
+	{
+		const auto& packEntry = packEntries[i];
+		const Ogre::String name{ pack->at(packEntry.nameOffset, packEntry.nameLength), packEntry.nameLength };
+		if (name.compare(0, prefix.size(), prefix) != 0) continue;
+		entries.push_back({ name.substr(prefix.size()), pack->at(packEntry.dataOffset, packEntry.dataLength), packEntry.dataLength });
+	}
+}
+
+void HlmsPackArchive::unload()
+{
+	entries.clear();
+	pack.reset();
+}
+
+const HlmsPackArchive::Entry* HlmsPackArchive::findEntry(const Ogre::String& filename) const
+{
+	const auto entry = std::lower_bound(entries.begin(), entries.end(), filename,
+										[](const Entry& lhs, const Ogre::String& rhs) { return lhs.name < rhs; });
+	return entry != entries.end() && entry->name == filename ? &*entry : nullptr;
+}
+
+Ogre::DataStreamPtr HlmsPackArchive::open(const Ogre::String& filename, bool readOnly) const
+{
+	const auto entry = findEntry(filename);
+	if (!entry)
+		OGRE_EXCEPT(Ogre::Exception::ERR_FILE_NOT_FOUND, "Cannot find " + filename + " in " + mName, "HlmsPackArchive::open");
+
+	//Straight from the mapped file. The stream never frees or writes that memory
+	return Ogre::DataStreamPtr(OGRE_NEW Ogre::MemoryDataStream(filename, const_cast<char*>(entry->data), entry->size, false, true));
+}
+
+void HlmsPackArchive::fillFileInfo(Ogre::FileInfoList& list, const Ogre::String& pattern) const
+{
+	for (const auto& entry : entries)
+	{
+		if (!pattern.empty() && !Ogre::StringUtil::match(entry.name, pattern, true)) continue;
+
+		Ogre::FileInfo info;
+		info.archive = this;
+		info.filename = entry.name;
+		Ogre::StringUtil::splitFilename(entry.name, info.basename, info.path);
+		info.compressedSize = entry.size;
+		info.uncompressedSize = entry.size;
+		list.push_back(info);
+	}
+}
+
+Ogre::StringVectorPtr HlmsPackArchive::list(bool recursive, bool dirs)
+{
+	return find("*", recursive, dirs);
+}
+
+Ogre::FileInfoListPtr HlmsPackArchive::listFileInfo(bool recursive, bool dirs)
+{
+	return findFileInfo("*", recursive, dirs);
+}
+
+Ogre::StringVectorPtr HlmsPackArchive::find(const Ogre::String& pattern, bool recursive, bool dirs)
+{
+	Ogre::StringVectorPtr names(OGRE_NEW_T(Ogre::StringVector, Ogre::MEMCATEGORY_GENERAL)(), Ogre::SPFM_DELETE_T);
+	for (const auto& info : *findFileInfo(pattern, recursive, dirs))
+		names->push_back(info.filename);
+	return names;
+}
+
+Ogre::FileInfoListPtr HlmsPackArchive::findFileInfo(const Ogre::String& pattern, bool recursive, bool dirs) const
+{
+	//The pack only holds files. Templates are in flat folders, so "recursive" changes nothing
+	Ogre::FileInfoListPtr list(OGRE_NEW_T(Ogre::FileInfoList, Ogre::MEMCATEGORY_GENERAL)(), Ogre::SPFM_DELETE_T);
+	if (!dirs) fillFileInfo(*list, pattern == "*" ? Ogre::String{} : pattern);
+	return list;
+}
+
+bool HlmsPackArchive::exists(const Ogre::String& filename)
+{
+	return findEntry(filename) != nullptr;
+}
+
+time_t HlmsPackArchive::getModifiedTime(const Ogre::String& filename)
+{
+	return pack ? pack->getModifiedTime() : 0;
+}
+
+const Ogre::String& HlmsPackArchiveFactory::getType() const
+{
+	static const Ogre::String typeName{ HlmsPackArchive::type };
+	return typeName;
+}
+
+Ogre::Archive* HlmsPackArchiveFactory::createInstance(const Ogre::String& name, bool readOnly)
+{
+	return OGRE_NEW HlmsPackArchive(name, getType());
+}
+
+void HlmsPackArchiveFactory::destroyInstance(Ogre::Archive* archive)
+{
+	OGRE_DELETE archive;
+}
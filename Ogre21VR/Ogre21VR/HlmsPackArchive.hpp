@@ -0,0 +1,66 @@
+#pragma once
+#include <Windows.h>
+
+//C++ standard libraries
+#include <memory>
+#include <string>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreArchive.h>
+#include <OGRE/OgreArchiveFactory.h>
+
+class HlmsPackFile;
+
+///Read only Ogre archive over one folder of a .hlmspack file, for example "HLMS.hlmspack|Hlms/Pbs/GLSL".
+///The pack is memory mapped once for all its archives : there's no directory to scan, and opening a template doesn't copy it
+class HlmsPackArchive : public Ogre::Archive
+{
+public:
+	///Archive type to give to the ArchiveManager
+	static constexpr const char* const type{ "HlmsPack" };
+	///Between the path of the pack and the folder inside of it, in the archive names
+	static constexpr char separator{ '|' };
+
+	HlmsPackArchive(const Ogre::String& name, const Ogre::String& archiveType);
+	~HlmsPackArchive();
+
+	bool isCaseSensitive() const override;
+	void load() override;
+	void unload() override;
+	Ogre::DataStreamPtr open(const Ogre::String& filename, bool readOnly = true) const override;
+	Ogre::StringVectorPtr list(bool recursive = true, bool dirs = false) override;
+	Ogre::FileInfoListPtr listFileInfo(bool recursive = true, bool dirs = false) override;
+	Ogre::StringVectorPtr find(const Ogre::String& pattern, bool recursive = true, bool dirs = false) override;
+	Ogre::FileInfoListPtr findFileInfo(const Ogre::String& pattern, bool recursive = true, bool dirs = false) const override;
+	bool exists(const Ogre::String& filename) override;
+	time_t getModifiedTime(const Ogre::String& filename) override;
+
+private:
+	///A template of this folder, pointing in the mapped pack
+	struct Entry
+	{
+		Ogre::String name;
+		const char* data;
+		size_t size;
+	};
+
+	///Return the template with that name, nullptr if there's none
+	const Entry* findEntry(const Ogre::String& filename) const;
+	///Fill "list" with the templates matching "pattern". An empty pattern matches everything
+	void fillFileInfo(Ogre::FileInfoList& list, const Ogre::String& pattern) const;
+
+	std::shared_ptr<HlmsPackFile> pack;
+	///Sorted by name, like in the pack
+	std::vector<Entry> entries;
+};
+
+///Create the HlmsPackArchive instances for the ArchiveManager
+class HlmsPackArchiveFactory : public Ogre::ArchiveFactory
+{
+public:
+	const Ogre::String& getType() const override;
+	Ogre::Archive* createInstance(const Ogre::String& name, bool readOnly) override;
+	void destroyInstance(Ogre::Archive* archive) override;
+};
@@ -0,0 +1,176 @@
+#include "HlmsTierSwitcher.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <OGRE/OgreRenderable.h>
+#include <OGRE/Hlms/PbsMobile/OgreHlmsPbsMobile.h>
+#include <OGRE/Hlms/UnlitMobile/OgreHlmsUnlitMobile.h>
+
+#include "VertexCompressor.hpp"
+
+constexpr Ogre::HlmsTypes HlmsTierSwitcher::mobilePbsType;
+constexpr Ogre::HlmsTypes HlmsTierSwitcher::mobileUnlitType;
+
+namespace
+{
+	//The mobile HLMS take the PBS and Unlit slots in their constructor. Moving them to the user slots lets the desktop ones stay
+
+	class HlmsPbsMobileTier : public Ogre::HlmsPbsMobile
+	{
+	public:
+		HlmsPbsMobileTier(Ogre::Archive* dataFolder, Ogre::ArchiveVec* libraryFolders) :
+			HlmsPbsMobile(dataFolder, libraryFolders)
+		{
+			mType = HlmsTierSwitcher::mobilePbsType;
+		}
+
+	protected:
+		//Compressed normals have to be decoded on this tier too : a renderable can be moved to it at any time
+		void calculateHashForPreCreate(Ogre::Renderable* renderable, Ogre::PiecesMap* inOutPieces) override
+		{
+			HlmsPbsMobile::calculateHashForPreCreate(renderable, inOutPieces);
+
+			switch (VertexCompressor::getNormalPacking(renderable))
+			{
+			case NormalPacking::Octahedral:
+				setProperty(VertexCompressor::octahedralNormalProperty, 1);
+				break;
+			case NormalPacking::Int1010102:
+				setProperty(Ogre::HlmsBaseProp::QTangent, 0);
+				setProperty(Ogre::HlmsBaseProp::Normal, 1);
+				break;
+			default:
+				break;
+			}
+		}
+	};
+
+	class HlmsUnlitMobileTier : public Ogre::HlmsUnlitMobile
+	{
+	public:
+		HlmsUnlitMobileTier(Ogre::Archive* dataFolder, Ogre::ArchiveVec* libraryFolders) :
+			HlmsUnlitMobile(dataFolder, libraryFolders)
+		{
+			mType = HlmsTierSwitcher::mobileUnlitType;
+		}
+	};
+
+	///Name of the mobile twin of a material. Datablock names are shared by all the HLMS
+	Ogre::String mobileName(const Ogre::String& name)
+	{
+		return name + "/Mobile";
+	}
+}
+
+void HlmsTierSwitcher::registerMobileHlms(Ogre::HlmsManager* hlmsManager, Ogre::Archive* archivePbsMobile, Ogre::Archive* archiveUnlitMobile,
+										  Ogre::ArchiveVec& library)
+{
+	hlmsManager->registerHlms(OGRE_NEW HlmsPbsMobileTier(archivePbsMobile, &library));
+	hlmsManager->registerHlms(OGRE_NEW HlmsUnlitMobileTier(archiveUnlitMobile, &library));
+}
+
+HlmsTierSwitcher::HlmsTierSwitcher(Ogre::HlmsManager* hlmsManager) :
+	hlmsManager{ hlmsManager },
+	tier{ HlmsTier::Desktop },
+	automatic{ false },
+	gpuBudgetMs{ 10 },
+	recoverFraction{ 0.7 },
+	switchFrames{ 90 },
+	pressureFrames{ 0 }
+{
+}
+
+Ogre::HlmsDatablock* HlmsTierSwitcher::createDatablock(Ogre::HlmsTypes type, const Ogre::String& name, const Ogre::HlmsMacroblock& macroblock,
+													   const Ogre::HlmsBlendblock& blendblock, const Ogre::HlmsParamVec& parameters)
+{
+	const auto mobileType = type == Ogre::HLMS_UNLIT ? mobileUnlitType : mobilePbsType;
+	auto desktopHlms = hlmsManager->getHlms(type);
+	auto mobileHlms = hlmsManager->getHlms(mobileType);
+	if (!desktopHlms || !mobileHlms)
+		throw std::runtime_error("Both HLMS tiers need to be registered before creating the tiered material " + name);
+
+	//The mobile HLMS parse the same parameter names as the desktop ones
+	TieredDatablock datablock{};
+	datablock.desktop = desktopHlms->createDatablock(name, name, macroblock, blendblock, parameters);
+	datablock.mobile = mobileHlms->createDatablock(mobileName(name), mobileName(name), macroblock, blendblock, parameters);
+	datablocks[name] = datablock;
+
+	return tierOf(datablock) == HlmsTier::Desktop ? datablock.desktop : datablock.mobile;
+}
+
+void HlmsTierSwitcher::pinDatablock(const Ogre::String& name, HlmsTier pinnedTier)
+{
+	auto& datablock = datablocks.at(name);
+	datablock.pinned = true;
+	datablock.pinnedTier = pinnedTier;
+	moveRenderables(datablock, pinnedTier);
+}
+
+void HlmsTierSwitcher::unpinDatablock(const Ogre::String& name)
+{
+	auto& datablock = datablocks.at(name);
+	datablock.pinned = false;
+	moveRenderables(datablock, tier);
+}
+
+void HlmsTierSwitcher::setTier(HlmsTier newTier)
+{
+	pressureFrames = 0;
+	if (newTier == tier) return;
+	tier = newTier;
+
+	for (const auto& datablock : datablocks)
+		moveRenderables(datablock.second, tierOf(datablock.second));
+
+	Ogre::LogManager::getSingleton().logMessage(tier == HlmsTier::Desktop ? "HLMS tier : desktop" : "HLMS tier : mobile");
+}
+
+HlmsTier HlmsTierSwitcher::getTier() const
+{
+	return tier;
+}
+
+void HlmsTierSwitcher::setAutomatic(bool enable, double budgetMs, size_t frames, double recover)
+{
+	automatic = enable;
+	gpuBudgetMs = budgetMs;
+	switchFrames = frames;
+	recoverFraction = recover;
+	pressureFrames = 0;
+}
+
+void HlmsTierSwitcher::update(double lastGpuMs)
+{
+	if (!automatic) return;
+
+	//Only sustained overload switches, not a single long frame (shader compilation, streaming...)
+	if (lastGpuMs > gpuBudgetMs)
+		pressureFrames = pressureFrames > 0 ? pressureFrames + 1 : 1;
+	else if (lastGpuMs < gpuBudgetMs * recoverFraction)
+		pressureFrames = pressureFrames < 0 ? pressureFrames - 1 : -1;
+	else
+		pressureFrames = 0;
+
+	//The mobile tier is cheaper, so its GPU time says little about the desktop one. The headroom needed to go back is large on purpose
+	if (tier == HlmsTier::Desktop && pressureFrames >= long(switchFrames))
+		setTier(HlmsTier::Mobile);
+	else if (tier == HlmsTier::Mobile && -pressureFrames >= long(switchFrames))
+		setTier(HlmsTier::Desktop);
+}
+
+void HlmsTierSwitcher::moveRenderables(const TieredDatablock& datablock, HlmsTier target)
+{
+	const auto from = target == HlmsTier::Desktop ? datablock.mobile : datablock.desktop;
+	const auto to = target == HlmsTier::Desktop ? datablock.desktop : datablock.mobile;
+
+	//setDatablock unlinks the renderable from the list being walked
+	const std::vector<Ogre::Renderable*> renderables(from->getLinkedRenderables().begin(), from->getLinkedRenderables().end());
+	for (auto renderable : renderables)
+		renderable->setDatablock(to);
+}
+
+HlmsTier HlmsTierSwitcher::tierOf(const TieredDatablock& datablock) const
+{
+	return datablock.pinned ? datablock.pinnedTier : tier;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+//C++ standard libraries
+#include <map>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreHlms.h>
+#include <OGRE/OgreHlmsManager.h>
+#include <OGRE/OgreHlmsDatablock.h>
+
+///Shading quality of a material
+enum class HlmsTier
+{
+	///HlmsPbs and HlmsUnlit, with the stereo pass data, the light grid and the shadows
+	Desktop,
+	///HlmsPbsMobile and HlmsUnlitMobile : a few uniforms per draw, no Forward3D or stereo light grid. For standalone and low end PCs
+	Mobile
+};
+
+///Keep each tiered material in both HLMS, and switch the renderables from one to the other at runtime. Items are never recreated :
+///a renderable only has to be given the datablock of the other tier. It can also do it by itself when the GPU can't keep up
+class HlmsTierSwitcher
+{
+public:
+	///The mobile HLMS are registered in user slots, so both tiers are there at the same time
+	static constexpr Ogre::HlmsTypes mobilePbsType{ Ogre::HLMS_USER0 };
+	static constexpr Ogre::HlmsTypes mobileUnlitType{ Ogre::HLMS_USER1 };
+
+	///Register HlmsPbsMobile and HlmsUnlitMobile with their template archives
+	static void registerMobileHlms(Ogre::HlmsManager* hlmsManager, Ogre::Archive* archivePbsMobile, Ogre::Archive* archiveUnlitMobile,
+								   Ogre::ArchiveVec& library);
+
+	explicit HlmsTierSwitcher(Ogre::HlmsManager* hlmsManager);
+
+	///Create a material in both tiers from the same parameters. "type" is HLMS_PBS or HLMS_UNLIT.
+	///Return the datablock of the tier the material is on, to give to the items
+	Ogre::HlmsDatablock* createDatablock(Ogre::HlmsTypes type, const Ogre::String& name, const Ogre::HlmsMacroblock& macroblock,
+										 const Ogre::HlmsBlendblock& blendblock, const Ogre::HlmsParamVec& parameters);
+	///Keep that material on one tier, whatever the global tier is
+	void pinDatablock(const Ogre::String& name, HlmsTier tier);
+	///Let that material follow the global tier again
+	void unpinDatablock(const Ogre::String& name);
+
+	///Move every material that isn't pinned to that tier. Call it before creating the materials to choose the tier at startup
+	void setTier(HlmsTier tier);
+	HlmsTier getTier() const;
+
+	///Drop to the mobile tier after "frames" frames over "gpuBudgetMs" of GPU time, and go back after "frames" frames
+	///under "recoverFraction" of the budget. Disabled by default
+	void setAutomatic(bool enable, double gpuBudgetMs = 10, size_t frames = 90, double recoverFraction = 0.7);
+	///Give the GPU time of the last frame, to switch tiers when automatic. Called by the renderer
+	void update(double lastGpuMs);
+
+private:
+	struct TieredDatablock
+	{
+		Ogre::HlmsDatablock* desktop;
+		Ogre::HlmsDatablock* mobile;
+		bool pinned;
+		HlmsTier pinnedTier;
+	};
+
+	///Give the renderables of a material the datablock of that tier
+	static void moveRenderables(const TieredDatablock& datablock, HlmsTier tier);
+	HlmsTier tierOf(const TieredDatablock& datablock) const;
+
+	Ogre::HlmsManager* hlmsManager;
+	std::map<Ogre::String, TieredDatablock> datablocks;
+	HlmsTier tier;
+
+	bool automatic;
+	double gpuBudgetMs, recoverFraction;
+	size_t switchFrames;
+	///Consecutive frames over budget (positive) or with enough headroom (negative)
+	long pressureFrames;
+};
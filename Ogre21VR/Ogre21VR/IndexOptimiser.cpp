@@ -0,0 +1,295 @@
+#include "IndexOptimiser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <sstream>
+
+#include <OGRE/OgreSubMesh.h>
+#include <OGRE/OgreHardwareBufferManager.h>
+
+namespace
+{
+	///Simulated cache sizes in the report : most GPUs are somewhere in between
+	const size_t reportedCacheSizes[]{ 16, 32 };
+
+	///The triangle lists of a V1 submesh : LOD 0, then the generated ones
+	std::vector<Ogre::v1::IndexData*> triangleLists(Ogre::v1::SubMesh* subMesh)
+	{
+		std::vector<Ogre::v1::IndexData*> lists;
+		if (subMesh->operationType != Ogre::v1::RenderOperation::OT_TRIANGLE_LIST) return lists;
+
+		lists.push_back(subMesh->indexData[Ogre::VpNormal]);
+		for (auto lod : subMesh->mLodFaceList[Ogre::VpNormal])
+			lists.push_back(lod);
+		lists.erase(std::remove_if(lists.begin(), lists.end(), [](Ogre::v1::IndexData* list) { return !list || !list->indexCount; }), lists.end());
+		return lists;
+	}
+
+	std::vector<uint32_t> readIndices(const Ogre::v1::IndexData* indexData)
+	{
+		const auto& buffer = indexData->indexBuffer;
+		const auto indexSize = buffer->getIndexSize();
+		std::vector<uint32_t> indices(indexData->indexCount);
+		if (indexSize == sizeof(uint16_t))
+		{
+			std::vector<uint16_t> shortIndices(indices.size());
+			buffer->readData(indexData->indexStart * indexSize, indices.size() * indexSize, shortIndices.data());
+			std::copy(shortIndices.begin(), shortIndices.end(), indices.begin());
+		}
+		else
+			buffer->readData(indexData->indexStart * indexSize, indices.size() * indexSize, indices.data());
+		return indices;
+	}
+
+	void writeIndices(const Ogre::v1::IndexData* indexData, const std::vector<uint32_t>& indices)
+	{
+		const auto& buffer = indexData->indexBuffer;
+		const auto indexSize = buffer->getIndexSize();
+		if (indexSize == sizeof(uint16_t))
+		{
+			const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+			buffer->writeData(indexData->indexStart * indexSize, indices.size() * indexSize, shortIndices.data());
+		}
+		else
+			buffer->writeData(indexData->indexStart * indexSize, indices.size() * indexSize, indices.data());
+	}
+
+	///Positions of the vertices a submesh indexes, from its first vertex
+	std::vector<Ogre::Vector3> readPositions(const Ogre::v1::VertexData* vertexData)
+	{
+		std::vector<Ogre::Vector3> positions;
+		const auto element = vertexData->vertexDeclaration->findElementBySemantic(Ogre::VES_POSITION);
+		if (!element || element->getType() != Ogre::VET_FLOAT3) return positions;
+
+		const auto buffer = vertexData->vertexBufferBinding->getBuffer(element->getSource());
+		std::vector<char> data(vertexData->vertexCount * buffer->getVertexSize());
+		buffer->readData(vertexData->vertexStart * buffer->getVertexSize(), data.size(), data.data());
+
+		positions.resize(vertexData->vertexCount);
+		for (size_t i{ 0 }; i < positions.size(); ++i)
+		{
+			float* position;
+			element->baseVertexPointerToElement(data.data() + i * buffer->getVertexSize(), &position);
+			positions[i] = { position[0], position[1], position[2] };
+		}
+		return positions;
+	}
+
+	std::string format(const VertexCacheStats& stats)
+	{
+		std::ostringstream text;
+		text.precision(3);
+		text << std::fixed << "ACMR " << stats.acmr << " ATVR " << stats.atvr;
+		return text.str();
+	}
+}
+
+VertexCacheStats IndexOptimiser::simulate(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize)
+{
+	//A vertex is in the FIFO while less than cacheSize misses happened since it was loaded
+	std::vector<size_t> loadedAt(vertexCount, 0);
+	std::vector<bool> used(vertexCount, false);
+	size_t misses{ 0 }, usedCount{ 0 };
+	for (auto index : indices)
+	{
+		if (!used[index])
+		{
+			used[index] = true;
+			++usedCount;
+		}
+		else if (misses - loadedAt[index] < cacheSize) continue;
+
+		loadedAt[index] = misses++;
+	}
+
+	const auto triangles = indices.size() / 3;
+	return { triangles ? double(misses) / triangles : 0, usedCount ? double(misses) / usedCount : 0 };
+}
+
+void IndexOptimiser::optimise(std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize, const std::vector<Ogre::Vector3>* positions)
+{
+	const auto triangleCount = indices.size() / 3;
+	if (!triangleCount) return;
+
+	//Triangles using each vertex, in a flat array
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (auto index : indices)
+		++liveTriangles[index];
+	std::vector<size_t> firstTriangle(vertexCount + 1, 0);
+	std::partial_sum(liveTriangles.begin(), liveTriangles.end(), firstTriangle.begin() + 1);
+	std::vector<uint32_t> vertexTriangles(indices.size());
+	{
+		auto cursor = firstTriangle;
+		for (size_t i{ 0 }; i < indices.size(); ++i)
+			vertexTriangles[cursor[indices[i]]++] = uint32_t(i / 3);
+	}
+
+	std::vector<size_t> cachedAt(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds, candidates, output;
+	std::vector<size_t> clusterStarts{ 0 };
+	output.reserve(indices.size());
+	size_t timeStamp{ cacheSize + 1 };
+	uint32_t scanCursor{ 0 };
+
+	//Fan around a vertex, then move to the candidate still in the cache with the most triangles left
+	long fanning{ 0 };
+	while (fanning >= 0)
+	{
+		candidates.clear();
+		for (auto t{ firstTriangle[fanning] }; t < firstTriangle[fanning + 1]; ++t)
+		{
+			const auto triangle = vertexTriangles[t];
+			if (emitted[triangle]) continue;
+			emitted[triangle] = true;
+
+			for (size_t corner{ 0 }; corner < 3; ++corner)
+			{
+				const auto vertex = indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveTriangles[vertex];
+				if (timeStamp - cachedAt[vertex] > cacheSize)
+					cachedAt[vertex] = timeStamp++;
+			}
+		}
+
+		long next{ -1 };
+		long bestPriority{ -1 };
+		for (auto vertex : candidates)
+		{
+			if (!liveTriangles[vertex]) continue;
+
+			//Fanning it must not push its own triangles out of the cache
+			long priority{ 0 };
+			if (timeStamp - cachedAt[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+				priority = long(timeStamp - cachedAt[vertex]);
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = long(vertex);
+			}
+		}
+
+		//Dead end : go back to a recently used vertex, or to the next one with triangles left. The cache is lost, a cluster ends here
+		if (next < 0)
+		{
+			while (!deadEnds.empty() && next < 0)
+			{
+				if (liveTriangles[deadEnds.back()]) next = long(deadEnds.back());
+				deadEnds.pop_back();
+			}
+			while (next < 0 && scanCursor < vertexCount)
+			{
+				if (liveTriangles[scanCursor]) next = long(scanCursor);
+				++scanCursor;
+			}
+			if (next >= 0 && output.size() / 3 != clusterStarts.back())
+				clusterStarts.push_back(output.size() / 3);
+		}
+		fanning = next;
+	}
+
+	indices = std::move(output);
+	if (positions && positions->size() >= vertexCount)
+		sortClustersForOverdraw(indices, clusterStarts, *positions);
+}
+
+void IndexOptimiser::sortClustersForOverdraw(std::vector<uint32_t>& indices, const std::vector<size_t>& clusterStarts,
+											 const std::vector<Ogre::Vector3>& positions)
+{
+	struct Cluster
+	{
+		size_t start, end;
+		Ogre::Vector3 centroid, normal;
+		Ogre::Real area;
+		Ogre::Real facingOut;
+	};
+
+	const auto triangleCount = indices.size() / 3;
+	std::vector<Cluster> clusters;
+	Ogre::Vector3 meshCentroid{ Ogre::Vector3::ZERO };
+	Ogre::Real meshArea{ 0 };
+	for (size_t i{ 0 }; i < clusterStarts.size(); ++i)
+	{
+		Cluster cluster{ clusterStarts[i], i + 1 < clusterStarts.size() ? clusterStarts[i + 1] : triangleCount,
+						 Ogre::Vector3::ZERO, Ogre::Vector3::ZERO, 0, 0 };
+		for (auto t{ cluster.start }; t < cluster.end; ++t)
+		{
+			const auto& a = positions[indices[t * 3]];
+			const auto& b = positions[indices[t * 3 + 1]];
+			const auto& c = positions[indices[t * 3 + 2]];
+			const auto areaNormal = (b - a).crossProduct(c - a);
+			const auto area = areaNormal.length() * 0.5f;
+			cluster.centroid += (a + b + c) * (area / 3);
+			cluster.normal += areaNormal;
+			cluster.area += area;
+		}
+		if (cluster.area > 0) cluster.centroid /= cluster.area;
+		meshCentroid += cluster.centroid * cluster.area;
+		meshArea += cluster.area;
+		clusters.push_back(cluster);
+	}
+	if (meshArea > 0) meshCentroid /= meshArea;
+
+	//Sander's view independent heuristic : clusters far out of the mesh and facing away from its center are likely in front
+	for (auto& cluster : clusters)
+		cluster.facingOut = (cluster.centroid - meshCentroid).dotProduct(cluster.normal.normalisedCopy());
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& lhs, const Cluster& rhs) { return lhs.facingOut > rhs.facingOut; });
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indices.size());
+	for (const auto& cluster : clusters)
+		sorted.insert(sorted.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+	indices = std::move(sorted);
+}
+
+void IndexOptimiser::optimiseMesh(Ogre::v1::Mesh* mesh, size_t cacheSize, bool reduceOverdraw)
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<uint32_t> allBefore, allAfter;
+	//The report numbers the vertices of the whole mesh : the shared ones first, then those of each submesh
+	const auto sharedVertices = mesh->sharedVertexData[Ogre::VpNormal] ? mesh->sharedVertexData[Ogre::VpNormal]->vertexCount : 0;
+	size_t allVertices{ sharedVertices };
+
+	for (unsigned short i{ 0 }; i < mesh->getNumSubMeshes(); ++i)
+	{
+		const auto subMesh = mesh->getSubMesh(i);
+		const auto vertexData = subMesh->useSharedVertices ? mesh->sharedVertexData[Ogre::VpNormal] : subMesh->vertexData[Ogre::VpNormal];
+		if (!vertexData) continue;
+
+		const auto firstVertex = subMesh->useSharedVertices ? 0 : allVertices;
+
+		std::vector<Ogre::Vector3> positions;
+		if (reduceOverdraw) positions = readPositions(vertexData);
+
+		for (auto indexData : triangleLists(subMesh))
+		{
+			auto indices = readIndices(indexData);
+
+			//Only LOD 0 goes in the report, the others would count its vertices again
+			const auto report = indexData == subMesh->indexData[Ogre::VpNormal];
+			if (report)
+				for (auto index : indices)
+					allBefore.push_back(uint32_t(firstVertex + index));
+
+			optimise(indices, vertexData->vertexCount, cacheSize, positions.empty() ? nullptr : &positions);
+			writeIndices(indexData, indices);
+
+			if (report)
+				for (auto index : indices)
+					allAfter.push_back(uint32_t(firstVertex + index));
+		}
+		if (!subMesh->useSharedVertices) allVertices += vertexData->vertexCount;
+	}
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	auto& log = Ogre::LogManager::getSingleton();
+	log.logMessage("Index optimisation of " + mesh->getName() + " : " + std::to_string(allBefore.size() / 3) + " triangles in "
+				   + std::to_string(elapsed.count()) + "ms");
+	for (auto simulatedSize : reportedCacheSizes)
+		log.logMessage("  FIFO " + std::to_string(simulatedSize) + " : " + format(simulate(allBefore, allVertices, simulatedSize)) + " -> "
+					   + format(simulate(allAfter, allVertices, simulatedSize)));
+}
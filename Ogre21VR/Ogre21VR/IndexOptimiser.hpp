@@ -0,0 +1,38 @@
+#pragma once
+
+//C++ standard libraries
+#include <cstdint>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreMesh.h>
+
+///How a triangle list uses the post transform vertex cache
+struct VertexCacheStats
+{
+	///Average cache miss ratio : vertices transformed per triangle. 0.5 at best on a large grid, 3 at worst
+	double acmr;
+	///Average transform to vertex ratio : vertices transformed per vertex used. 1 at best
+	double atvr;
+};
+
+///Reorder the triangles of the meshes for the post transform cache, and measure it by simulating that cache on the CPU
+class IndexOptimiser
+{
+public:
+	///Reorder a triangle list for a FIFO cache of "cacheSize" vertices, with Tipsify (Sander, Nehab, Barczak 2007).
+	///With positions, the clusters of triangles Tipsify leaves are then sorted so the ones facing out of the mesh are drawn first :
+	///they hide the rest, so less pixels are shaded twice
+	static void optimise(std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize, const std::vector<Ogre::Vector3>* positions = nullptr);
+	///Simulate a FIFO cache of "cacheSize" vertices on a triangle list
+	static VertexCacheStats simulate(const std::vector<uint32_t>& indices, size_t vertexCount, size_t cacheSize);
+
+	///Optimise every triangle list of a V1 mesh, LODs included, and log the simulated cache stats before and after
+	static void optimiseMesh(Ogre::v1::Mesh* mesh, size_t cacheSize, bool reduceOverdraw);
+
+private:
+	///Sort the clusters starting at "clusterStarts" (in triangles) by how much they face out of the mesh
+	static void sortClustersForOverdraw(std::vector<uint32_t>& indices, const std::vector<size_t>& clusterStarts,
+										const std::vector<Ogre::Vector3>& positions);
+};
@@ -0,0 +1,174 @@
+#include "MemoryTracker.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	std::string megabytes(size_t bytes)
+	{
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << "MiB";
+		return text.str();
+	}
+}
+
+MemoryTracker::MemoryTracker() :
+	gpuBudget{ 0, nullptr, false },
+	cpuBudget{ 0, nullptr, false }
+{
+	gpuCategoryBudgets.fill({ 0, nullptr, false });
+}
+
+void MemoryTracker::setGpu(GpuMemory category, const std::string& name, size_t bytes)
+{
+	auto& allocations = gpuAllocations[size_t(category)];
+	if (bytes) allocations[name] = bytes;
+	else allocations.erase(name);
+}
+
+void MemoryTracker::setCpu(const std::string& subsystem, const std::string& name, size_t bytes)
+{
+	auto& allocations = cpuAllocations[subsystem];
+	if (bytes) allocations[name] = bytes;
+	else allocations.erase(name);
+}
+
+void MemoryTracker::addGpuSource(GpuMemory category, const std::string& name, Source source)
+{
+	gpuSources[size_t(category)][name] = std::move(source);
+}
+
+void MemoryTracker::addCpuSource(const std::string& subsystem, const std::string& name, Source source)
+{
+	cpuSources[subsystem][name] = std::move(source);
+}
+
+Ogre::Resource::Listener* MemoryTracker::getUnloadListener(GpuMemory category)
+{
+	auto& listener = unloadListeners[size_t(category)];
+	if (!listener) listener = std::make_unique<UnloadListener>(*this, category);
+	return listener.get();
+}
+
+MemoryTracker::UnloadListener::UnloadListener(MemoryTracker& tracker, GpuMemory category) :
+	tracker(tracker),
+	category{ category }
+{
+}
+
+void MemoryTracker::UnloadListener::unloadingComplete(Ogre::Resource* resource)
+{
+	tracker.setGpu(category, resource->getName(), 0);
+}
+
+void MemoryTracker::setGpuBudget(size_t bytes, BudgetCallback onExceeded)
+{
+	gpuBudget = { bytes, std::move(onExceeded), false };
+}
+
+void MemoryTracker::setGpuBudget(GpuMemory category, size_t bytes, BudgetCallback onExceeded)
+{
+	gpuCategoryBudgets[size_t(category)] = { bytes, std::move(onExceeded), false };
+}
+
+void MemoryTracker::setCpuBudget(size_t bytes, BudgetCallback onExceeded)
+{
+	cpuBudget = { bytes, std::move(onExceeded), false };
+}
+
+MemorySnapshot MemoryTracker::snapshot() const
+{
+	MemorySnapshot snapshot{};
+	for (size_t category{ 0 }; category < size_t(GpuMemory::Count); ++category)
+	{
+		const std::string prefix{ getName(GpuMemory(category)) };
+		for (const auto& allocation : gpuAllocations[category])
+		{
+			snapshot.gpu[category] += allocation.second;
+			snapshot.gpuAllocations.emplace_back(prefix + " / " + allocation.first, allocation.second);
+		}
+		for (const auto& source : gpuSources[category])
+		{
+			const auto bytes = source.second();
+			snapshot.gpu[category] += bytes;
+			snapshot.gpuAllocations.emplace_back(prefix + " / " + source.first, bytes);
+		}
+		snapshot.gpuTotal += snapshot.gpu[category];
+	}
+
+	for (const auto& subsystem : cpuAllocations)
+		for (const auto& allocation : subsystem.second)
+			snapshot.cpu[subsystem.first] += allocation.second;
+	for (const auto& subsystem : cpuSources)
+		for (const auto& source : subsystem.second)
+			snapshot.cpu[subsystem.first] += source.second();
+	for (const auto& subsystem : snapshot.cpu)
+		snapshot.cpuTotal += subsystem.second;
+
+	std::sort(snapshot.gpuAllocations.begin(), snapshot.gpuAllocations.end(),
+			  [](const std::pair<std::string, size_t>& lhs, const std::pair<std::string, size_t>& rhs) { return lhs.second > rhs.second; });
+	return snapshot;
+}
+
+void MemoryTracker::dump() const
+{
+	const auto memory = snapshot();
+	auto& log = Ogre::LogManager::getSingleton();
+
+	log.logMessage("Memory : " + megabytes(memory.gpuTotal) + " GPU, " + megabytes(memory.cpuTotal) + " CPU");
+	for (size_t category{ 0 }; category < size_t(GpuMemory::Count); ++category)
+		log.logMessage("  GPU " + std::string(getName(GpuMemory(category))) + " : " + megabytes(memory.gpu[category]));
+	for (const auto& subsystem : memory.cpu)
+		log.logMessage("  CPU " + subsystem.first + " : " + megabytes(subsystem.second));
+	for (const auto& allocation : memory.gpuAllocations)
+		log.logMessage("    " + allocation.first + " : " + megabytes(allocation.second));
+}
+
+void MemoryTracker::check(Budget& budget, size_t used) const
+{
+	const auto exceeded = budget.bytes && used > budget.bytes;
+	if (exceeded && !budget.exceeded && budget.onExceeded)
+		budget.onExceeded(snapshot());
+	budget.exceeded = exceeded;
+}
+
+void MemoryTracker::update()
+{
+	std::array<size_t, size_t(GpuMemory::Count)> gpu{};
+	size_t gpuTotal{ 0 }, cpuTotal{ 0 };
+	for (size_t category{ 0 }; category < size_t(GpuMemory::Count); ++category)
+	{
+		for (const auto& allocation : gpuAllocations[category])
+			gpu[category] += allocation.second;
+		for (const auto& source : gpuSources[category])
+			gpu[category] += source.second();
+		gpuTotal += gpu[category];
+	}
+	for (const auto& subsystem : cpuAllocations)
+		for (const auto& allocation : subsystem.second)
+			cpuTotal += allocation.second;
+	for (const auto& subsystem : cpuSources)
+		for (const auto& source : subsystem.second)
+			cpuTotal += source.second();
+
+	check(gpuBudget, gpuTotal);
+	for (size_t category{ 0 }; category < size_t(GpuMemory::Count); ++category)
+		check(gpuCategoryBudgets[category], gpu[category]);
+	check(cpuBudget, cpuTotal);
+}
+
+const char* MemoryTracker::getName(GpuMemory category)
+{
+	switch (category)
+	{
+	case GpuMemory::EyeTargets: return "Eye targets";
+	case GpuMemory::Overlays: return "Overlays";
+	case GpuMemory::ShadowMaps: return "Shadow maps";
+	case GpuMemory::Meshes: return "Meshes";
+	case GpuMemory::Textures: return "Textures";
+	case GpuMemory::ConstantBuffers: return "Constant buffers";
+	default: return "Unknown";
+	}
+}
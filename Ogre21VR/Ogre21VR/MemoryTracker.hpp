@@ -0,0 +1,112 @@
+#pragma once
+
+//C++ standard libraries
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+
+///What a GPU allocation is used for
+enum class GpuMemory
+{
+	///Eye buffers, their depth buffers, and the VR runtime swapchains
+	EyeTargets,
+	///Overlay layer render targets and swapchains
+	Overlays,
+	ShadowMaps,
+	///Vertex and index buffers of the converted meshes
+	Meshes,
+	///Every texture that isn't a render target
+	Textures,
+	///Uniform and per frame upload buffers
+	ConstantBuffers,
+	Count
+};
+
+///Memory used at one point in time
+struct MemorySnapshot
+{
+	std::array<size_t, size_t(GpuMemory::Count)> gpu;
+	size_t gpuTotal;
+	///By subsystem
+	std::map<std::string, size_t> cpu;
+	size_t cpuTotal;
+	///Every GPU allocation, named after its category, largest first
+	std::vector<std::pair<std::string, size_t>> gpuAllocations;
+};
+
+///Account the memory of the renderer : the GPU allocations by category, and the CPU side by subsystem.
+///The allocations made by this project are reported where they are made. What Ogre allocates by itself is sampled from its managers
+class MemoryTracker
+{
+public:
+	using BudgetCallback = std::function<void(const MemorySnapshot&)>;
+	using Source = std::function<size_t()>;
+
+	MemoryTracker();
+
+	///Account "bytes" of GPU memory under "name". Setting a name again replaces its size, 0 forgets it
+	void setGpu(GpuMemory category, const std::string& name, size_t bytes);
+	///Account "bytes" of CPU memory under "name", in a subsystem
+	void setCpu(const std::string& subsystem, const std::string& name, size_t bytes);
+	///Sample the size of something allocated elsewhere at each snapshot
+	void addGpuSource(GpuMemory category, const std::string& name, Source source);
+	void addCpuSource(const std::string& subsystem, const std::string& name, Source source);
+	///Listener forgetting the GPU memory accounted under the name of a resource once it's unloaded. Add it to the resources given to setGpu
+	Ogre::Resource::Listener* getUnloadListener(GpuMemory category);
+
+	///Call "onExceeded" once each time the GPU total goes over "bytes". 0 disables it
+	void setGpuBudget(size_t bytes, BudgetCallback onExceeded);
+	///Same for a single GPU category
+	void setGpuBudget(GpuMemory category, size_t bytes, BudgetCallback onExceeded);
+	///Same for the CPU total
+	void setCpuBudget(size_t bytes, BudgetCallback onExceeded);
+
+	///Sample the sources and add everything up
+	MemorySnapshot snapshot() const;
+	///Write a snapshot to the Ogre log : the totals, then every allocation, largest first
+	void dump() const;
+	///Check the budgets. Only the totals are added up, without allocating : a snapshot is only taken for the callbacks.
+	///The renderer calls it every frame
+	void update();
+
+	static const char* getName(GpuMemory category);
+
+private:
+	struct Budget
+	{
+		size_t bytes;
+		BudgetCallback onExceeded;
+		///Over budget at the last update, to only call back when crossing it
+		bool exceeded;
+	};
+
+	///Call the budget back with a snapshot if "used" just crossed it
+	void check(Budget& budget, size_t used) const;
+
+	class UnloadListener : public Ogre::Resource::Listener
+	{
+	public:
+		UnloadListener(MemoryTracker& tracker, GpuMemory category);
+		void unloadingComplete(Ogre::Resource* resource) override;
+
+	private:
+		MemoryTracker& tracker;
+		const GpuMemory category;
+	};
+
+	std::array<std::map<std::string, size_t>, size_t(GpuMemory::Count)> gpuAllocations;
+	std::array<std::map<std::string, Source>, size_t(GpuMemory::Count)> gpuSources;
+	std::map<std::string, std::map<std::string, size_t>> cpuAllocations;
+	std::map<std::string, std::map<std::string, Source>> cpuSources;
+
+	Budget gpuBudget;
+	std::array<Budget, size_t(GpuMemory::Count)> gpuCategoryBudgets;
+	Budget cpuBudget;
+	std::array<std::unique_ptr<UnloadListener>, size_t(GpuMemory::Count)> unloadListeners;
+};
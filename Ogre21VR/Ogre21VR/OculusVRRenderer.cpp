@@ -3,12 +3,15 @@
 OculusVRRenderer::OculusVRRenderer(int OpenGLMajor, int OpenGLMinor) : VRRenderer{ OpenGLMajor, OpenGLMinor },
 mirrorTexture{ nullptr },
 textureSwapchain{ nullptr },
+depthSwapchain{ nullptr },
 layers{ nullptr },
 currentFrameDisplayTime{ 0 },
 frameCounter{ 0 },
 currentIndex{ 0 },
-renderTextureGLID{ 0 },
+currentDepthIndex{ 0 },
+projectionFlags{ ovrProjection_None },
 oculusRenderTextureGLID{ 0 },
+oculusDepthTextureGLID{ 0 },
 fbo{ 0 }
 {
 	ovr_Initialize(nullptr);
@@ -31,6 +34,8 @@ fbo{ 0 }
 
 OculusVRRenderer::~OculusVRRenderer()
 {
+	for (auto swapchain : overlaySwapchains)
+		ovr_DestroyTextureSwapChain(session, swapchain);
 	ovr_Destroy(session);
 	ovr_Shutdown();
 }
@@ -40,45 +45,114 @@ void OculusVRRenderer::renderAndSubmitFrame()
 {
 	//debugFrame++;
 	//if (debugFrame == 115)
-	//	rttTexture->getBuffer()->getRenderTarget()->writeContentsToTimestampedFile("debug_", "_.png");
+	//	eyeBuffers[currentEyeBuffer].texture->getBuffer()->getRenderTarget()->writeContentsToTimestampedFile("debug_", "_.png");
 	updateEvents();
 
 	ovr_GetTextureSwapChainCurrentIndex(session, textureSwapchain, &currentIndex);
 	ovr_GetTextureSwapChainBufferGL(session, textureSwapchain, currentIndex, &oculusRenderTextureGLID);
+	if (depthSwapchain)
+	{
+		ovr_GetTextureSwapChainCurrentIndex(session, depthSwapchain, &currentDepthIndex);
+		ovr_GetTextureSwapChainBufferGL(session, depthSwapchain, currentDepthIndex, &oculusDepthTextureGLID);
+	}
+
+	beginFrameUploads();
+	reloadChangedHlms();
+	applyReverseDepthToDatablocks();
+	updateTextureStreaming();
 
 	//Texture should be written at this point
-	compositorWorkspaces[0]->setEnabled(false);
-	compositorWorkspaces[1]->setEnabled(true);
-	compositorWorkspaces[2]->setEnabled(true);
+	monoscopicWorkspace->setEnabled(false);
+	auto& eyeBuffer = acquireEyeBuffer();
+	prepareOverlayLayers();
 	getOgreRoot()->renderOneFrame();
 
-	glCopyImageSubData(renderTextureGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
+	glCopyImageSubData(eyeBuffer.colorGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
 					   oculusRenderTextureGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
 					   bufferSize.w, bufferSize.h, 1);
 
-	compositorWorkspaces[0]->setEnabled(true);
-	compositorWorkspaces[1]->setEnabled(false);
-	compositorWorkspaces[2]->setEnabled(false);
-	getOgreRoot()->renderOneFrame();
+	//The depth buffer follows the exact same path as the color one : no extra rendering pass, just the copy
+	if (depthSwapchain && getDepthGLID(eyeBuffer))
+		glCopyImageSubData(eyeBuffer.depthGLID, eyeBuffer.depthTarget, 0, 0, 0, 0,
+						   oculusDepthTextureGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
+						   bufferSize.w, bufferSize.h, 1);
 
+	//Next time this buffer comes around, we'll wait until these copies are done instead of letting the driver serialize
+	releaseEyeBuffer();
+
+	//The eye layer is always the first one submitted. The list only lives until the frame is submitted
 	layers = &layer.Header;
+	auto layerList = makeFrameVector<ovrLayerHeader*>();
+	layerList.reserve(1 + overlayLayers.size());
+	layerList.push_back(layers);
+	submitOverlayLayers(layerList);
+
+	monoscopicWorkspace->setEnabled(true);
+	getOgreRoot()->renderOneFrame();
+	endFrameUploads();
+
 	ovr_CommitTextureSwapChain(session, textureSwapchain);
-	ovr_SubmitFrame(session, 0, nullptr, &layers, 1);
+	if (depthSwapchain) ovr_CommitTextureSwapChain(session, depthSwapchain);
+	ovr_SubmitFrame(session, 0, nullptr, layerList.data(), unsigned(layerList.size()));
+	frameSubmitted();
 }
 
 void OculusVRRenderer::updateTracking()
 {
 	ts = ovr_GetTrackingState(session, currentFrameDisplayTime = ovr_GetPredictedDisplayTime(session, 0), ovrTrue);
 
-	pose = ts.HeadPose.ThePose;
+	std::array<VRPose, size_t(VRDevice::Count)> poses;
+	poses[size_t(VRDevice::Head)] = oculusToVRPose(ts.HeadPose);
+	poses[size_t(VRDevice::LeftHand)] = oculusToVRPose(ts.HandPoses[ovrHand_Left]);
+	poses[size_t(VRDevice::RightHand)] = oculusToVRPose(ts.HandPoses[ovrHand_Right]);
+
+	//LibOVR already predicts to the display time. The predictor only adds what has been configured on top of it
+	auto& headPose = poses[size_t(VRDevice::Head)];
+	if (!replayPose(VRDevice::Head, headPose))
+		headPose = headPosePredictor.predict(headPose);
+	recordPose(VRDevice::Head, headPose);
+
+	pose.Orientation = ogreToOculusQuat(headPose.orientation);
+	pose.Position = ogreToOculusVect3(headPose.position);
 
 	ovr_CalcEyePoses(pose, offset.data(), layer.RenderPose);
 	cameraRig->setOrientation(oculusToOgreQuat(pose.Orientation));
 	cameraRig->setPosition(oculusToOgreVect3(pose.Position));
+
+	//The hands come from the same tracking state, so they are predicted for the same display time as the head
+	uint32_t buttons{ 0 };
+	if (OVR_SUCCESS(ovr_GetInputState(session, ovrControllerType_Touch, &inputState)))
+		buttons = inputState.Buttons;
+
+	const auto handTracked = [this](ovrHandType hand)
+	{
+		return (ts.HandStatusFlags[hand] & (ovrStatus_OrientationTracked | ovrStatus_PositionTracked)) != 0;
+	};
+	setDevicePose(VRDevice::LeftHand, handTracked(ovrHand_Left), poses[size_t(VRDevice::LeftHand)], buttons & ovrButton_LMask);
+	setDevicePose(VRDevice::RightHand, handTracked(ovrHand_Right), poses[size_t(VRDevice::RightHand)], buttons & ovrButton_RMask);
+	applyTrackedDevicePoses();
+
+	nextTrackingFrame();
 }
 
 Ogre::Quaternion OculusVRRenderer::oculusToOgreQuat(const ovrQuatf& q) { return Ogre::Quaternion{ q.w, q.x, q.y, q.z }; }
 Ogre::Vector3 OculusVRRenderer::oculusToOgreVect3(const ovrVector3f& v) { return Ogre::Vector3{ v.x, v.y, v.z }; }
+VRPose OculusVRRenderer::oculusToVRPose(const ovrPoseStatef& poseState)
+{
+	VRPose vrPose;
+	vrPose.orientation = oculusToOgreQuat(poseState.ThePose.Orientation);
+	vrPose.position = oculusToOgreVect3(poseState.ThePose.Position);
+	vrPose.angularVelocity = oculusToOgreVect3(poseState.AngularVelocity);
+	vrPose.linearVelocity = oculusToOgreVect3(poseState.LinearVelocity);
+	vrPose.angularAcceleration = oculusToOgreVect3(poseState.AngularAcceleration);
+	vrPose.linearAcceleration = oculusToOgreVect3(poseState.LinearAcceleration);
+	vrPose.timestamp = poseState.TimeInSeconds;
+	vrPose.hasDerivatives = true;
+	return vrPose;
+}
+
+ovrQuatf OculusVRRenderer::ogreToOculusQuat(const Ogre::Quaternion& q) { return ovrQuatf{ q.x, q.y, q.z, q.w }; }
+ovrVector3f OculusVRRenderer::ogreToOculusVect3(const Ogre::Vector3& v) { return ovrVector3f{ v.x, v.y, v.z }; }
 
 void OculusVRRenderer::initVRHardware()
 {
@@ -100,40 +174,36 @@ void OculusVRRenderer::initVRHardware()
 
 	if (ovr_CreateTextureSwapChainGL(session, &textureSwapChainDesc, &textureSwapchain) != ovrSuccess)
 		throw std::runtime_error("texture swap-chain cannot be created!");
-
-	ovr_GetTextureSwapChainBufferGL(session, textureSwapchain, 0, &renderTextureGLID);
-
-	rttTexture = getOgreRoot()->getTextureManager()->
-		createManual(rttTextureName,
-					 Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-					 Ogre::TEX_TYPE_2D, bufferSize.w, bufferSize.h, 0,
-					 Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET);
-
-	rttTexture->getCustomAttribute("GLID", &renderTextureGLID);
-
-	auto compositor = getOgreRoot()->getCompositorManager2();
-
-	if (!compositor->hasWorkspaceDefinition(stereoscopicCompositor))
-		compositor->createBasicWorkspaceDef(stereoscopicCompositor, backgroundColor);
-
-	Ogre::uint8 modifierMask, executionMask;
-	Ogre::Vector4 OffsetScale;
-
-	modifierMask = 0x01;
-	executionMask = 0x01;
-	OffsetScale = Ogre::Vector4{ 0, 0, 0.5f, 1 };
-	compositorWorkspaces[1] = compositor->addWorkspace(smgr, rttTexture->getBuffer()->getRenderTarget(), stereoCameras[0],
-													   stereoscopicCompositor, true, 1, OffsetScale, modifierMask, executionMask);
-
-	modifierMask = 0x02;
-	executionMask = 0x02;
-	OffsetScale = Ogre::Vector4{ 0.5f, 0, 0.5f, 1 };
-	compositorWorkspaces[2] = compositor->addWorkspace(smgr, rttTexture->getBuffer()->getRenderTarget(), stereoCameras[1],
-													   stereoscopicCompositor, true, 2, OffsetScale, modifierMask, executionMask);
+	memoryTracker.setGpu(GpuMemory::EyeTargets, "Oculus color swapchain", swapchainBytes(textureSwapchain, bufferSize.w, bufferSize.h, 4));
 
 	//Populate OVR structures
 	EyeRenderDesc[0] = ovr_GetRenderDesc(session, ovrEye_Left, hmdDesc.DefaultEyeFov[0]);
 	EyeRenderDesc[1] = ovr_GetRenderDesc(session, ovrEye_Right, hmdDesc.DefaultEyeFov[1]);
+	pixelsPerTangent = (bufferSize.w / 2) / (EyeRenderDesc[0].Fov.LeftTan + EyeRenderDesc[0].Fov.RightTan);
+	for (size_t eye{ 0 }; eye < 2; ++eye)
+	{
+		const auto& fov = EyeRenderDesc[eye].Fov;
+		eyeFov[eye] = { fov.LeftTan, fov.RightTan, fov.UpTan, fov.DownTan };
+	}
+
+	//A floating point depth buffer is what makes the reversed depth worth it. Keep stencil in both cases
+	//The depth is read back as a texture when it's submitted to the runtime
+	const auto depthFormat = reverseDepth ? Ogre::PF_D32_FLOAT_X24_S8_UINT : Ogre::PF_D24_UNORM_S8_UINT;
+	createEyeBuffers(bufferSize.w, bufferSize.h, depthFormat, depthSubmission);
+	projectionFlags = reverseDepth ? ovrProjection_FarLessThanNear | ovrProjection_FarClipAtInfinity : ovrProjection_None;
+
+	if (depthSubmission)
+	{
+		//Same layout as the color swapchain, but in the format of the depth buffer Ogre will attach to the RTT
+		ovrTextureSwapChainDesc depthSwapChainDesc = textureSwapChainDesc;
+		depthSwapChainDesc.Format = reverseDepth ? OVR_FORMAT_D32_FLOAT_S8X24_UINT : OVR_FORMAT_D24_UNORM_S8_UINT;
+		depthSwapChainDesc.BindFlags = ovrTextureBind_DX_DepthStencil;
+
+		if (ovr_CreateTextureSwapChainGL(session, &depthSwapChainDesc, &depthSwapchain) != ovrSuccess)
+			throw std::runtime_error("depth texture swap-chain cannot be created!");
+		memoryTracker.setGpu(GpuMemory::EyeTargets, "Oculus depth swapchain", swapchainBytes(depthSwapchain, bufferSize.w, bufferSize.h, reverseDepth ? 8 : 4));
+	}
+
 	offset[0] = EyeRenderDesc[0].HmdToEyeOffset;
 	offset[1] = EyeRenderDesc[1].HmdToEyeOffset;
 
@@ -141,10 +211,13 @@ void OculusVRRenderer::initVRHardware()
 	stereoCameras[1]->setPosition(oculusToOgreVect3(offset[1]));
 
 	//Create a layer with our single swaptexture on it. Each side is an eye.
-	layer.Header.Type = ovrLayerType_EyeFov;
+	//ovrLayerEyeFovDepth starts exactly like ovrLayerEyeFov, the header type tells the runtime what to read
+	layer.Header.Type = depthSwapchain ? ovrLayerType_EyeFovDepth : ovrLayerType_EyeFov;
 	layer.Header.Flags = 0;
 	layer.ColorTexture[0] = textureSwapchain;
 	layer.ColorTexture[1] = textureSwapchain;
+	layer.DepthTexture[0] = depthSwapchain;
+	layer.DepthTexture[1] = depthSwapchain;
 	layer.Fov[0] = EyeRenderDesc[0].Fov;
 	layer.Fov[1] = EyeRenderDesc[1].Fov;
 	ovrRecti leftRect, rightRect;
@@ -161,22 +234,116 @@ void OculusVRRenderer::initVRHardware()
 	setCorrectProjectionMatrix();
 }
 
-void OculusVRRenderer::setCorrectProjectionMatrix()
+size_t OculusVRRenderer::swapchainBytes(ovrTextureSwapChain swapchain, int width, int height, size_t bytesPerPixel) const
 {
-	const std::array<ovrMatrix4f, ovrEye_Count> oculusProjectionMatrix
+	int length{ 0 };
+	ovr_GetTextureSwapChainLength(session, swapchain, &length);
+	return size_t(length) * width * height * bytesPerPixel;
+}
+
+void OculusVRRenderer::initOverlayLayer(size_t layerIndex)
+{
+	const auto& overlay = overlayLayers[layerIndex];
+
+	ovrTextureSwapChainDesc textureSwapChainDesc = {};
+	textureSwapChainDesc.Type = ovrTexture_2D;
+	textureSwapChainDesc.ArraySize = 1;
+	textureSwapChainDesc.Format = OVR_FORMAT_R8G8B8A8_UNORM_SRGB;
+	textureSwapChainDesc.Width = int(overlay.width);
+	textureSwapChainDesc.Height = int(overlay.height);
+	textureSwapChainDesc.MipLevels = 1;
+	textureSwapChainDesc.SampleCount = 1;
+	textureSwapChainDesc.StaticImage = ovrFalse;
+
+	ovrTextureSwapChain swapchain;
+	if (ovr_CreateTextureSwapChainGL(session, &textureSwapChainDesc, &swapchain) != ovrSuccess)
+		throw std::runtime_error("overlay layer texture swap-chain cannot be created!");
+	overlaySwapchains.push_back(swapchain);
+	memoryTracker.setGpu(GpuMemory::Overlays, "Oculus overlay swapchain " + std::to_string(layerIndex),
+						 swapchainBytes(swapchain, int(overlay.width), int(overlay.height), 4));
+
+	ovrRecti viewport;
+	viewport.Pos.x = 0;
+	viewport.Pos.y = 0;
+	viewport.Size.w = int(overlay.width);
+	viewport.Size.h = int(overlay.height);
+
+	ovrLayer_Union ovrOverlay = {};
+	if (overlay.shape == VROverlayLayer::Shape::Quad)
 	{
-		ovrMatrix4f_Projection(EyeRenderDesc[ovrEye_Left].Fov, nearClippingDistance, farClippingDistance, 0),
-		ovrMatrix4f_Projection(EyeRenderDesc[ovrEye_Right].Fov, nearClippingDistance, farClippingDistance, 0)
-	};
+		ovrOverlay.Header.Type = ovrLayerType_Quad;
+		ovrOverlay.Quad.ColorTexture = swapchain;
+		ovrOverlay.Quad.Viewport = viewport;
+		ovrOverlay.Quad.QuadSize = ovrVector2f{ overlay.size.x, overlay.size.y };
+	}
+	else
+	{
+		ovrOverlay.Header.Type = ovrLayerType_Cylinder;
+		ovrOverlay.Cylinder.ColorTexture = swapchain;
+		ovrOverlay.Cylinder.Viewport = viewport;
+		ovrOverlay.Cylinder.CylinderRadius = overlay.radius;
+		ovrOverlay.Cylinder.CylinderAngle = overlay.centralAngle;
+		ovrOverlay.Cylinder.CylinderAspectRatio = (overlay.radius * overlay.centralAngle) / overlay.size.y;
+	}
+	overlayOvrLayers.push_back(ovrOverlay);
+}
+
+void OculusVRRenderer::submitOverlayLayers(ArenaVector<ovrLayerHeader*>& layerList)
+{
+	for (size_t i{ 0 }; i < overlayLayers.size(); ++i)
+	{
+		auto& overlay = overlayLayers[i];
+		auto& ovrOverlay = overlayOvrLayers[i];
+		if (!overlay.visible) continue;
+
+		//Only the layers rendered this frame are copied and commited. The others keep their last image
+		if (overlay.dirty)
+		{
+			int index;
+			GLuint overlayGLID, oculusOverlayGLID;
+			overlay.texture->getCustomAttribute("GLID", &overlayGLID);
+			ovr_GetTextureSwapChainCurrentIndex(session, overlaySwapchains[i], &index);
+			ovr_GetTextureSwapChainBufferGL(session, overlaySwapchains[i], index, &oculusOverlayGLID);
+
+			glCopyImageSubData(overlayGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
+							   oculusOverlayGLID, GL_TEXTURE_2D, 0, 0, 0, 0,
+							   GLsizei(overlay.width), GLsizei(overlay.height), 1);
+
+			ovr_CommitTextureSwapChain(session, overlaySwapchains[i]);
+			overlay.workspace->setEnabled(false);
+			overlay.dirty = false;
+		}
+
+		const ovrPosef pose{ ogreToOculusQuat(overlay.orientation), ogreToOculusVect3(overlay.position) };
+		ovrOverlay.Header.Flags = overlay.headLocked ? ovrLayerFlag_HeadLocked : 0;
+		if (overlay.shape == VROverlayLayer::Shape::Quad)
+			ovrOverlay.Quad.QuadPoseCenter = pose;
+		else
+			ovrOverlay.Cylinder.CylinderPoseCenter = pose;
+
+		layerList.push_back(&ovrOverlay.Header);
+	}
+}
+
+void OculusVRRenderer::setCorrectProjectionMatrix()
+{
+	std::array<ovrMatrix4f, ovrEye_Count> oculusProjectionMatrix;
+	for (const auto& eye : { ovrEye_Left, ovrEye_Right })
+		oculusProjectionMatrix[eye] = ovrMatrix4f_Projection(EyeRenderDesc[eye].Fov, nearClippingDistance, farClippingDistance, projectionFlags);
 
-	std::array<Ogre::Matrix4, 2> ogreProjectionMatrix{};
+	//The runtime needs to know how to get back a linear depth from the depth buffer content
+	layer.ProjectionDesc = ovrTimewarpProjectionDesc_FromProjection(oculusProjectionMatrix[ovrEye_Left], projectionFlags);
 
+	std::array<Ogre::Matrix4, 2> ogreProjectionMatrix;
 	for (const auto& eye : { 0, 1 })
 	{
 		for (auto x : { 0, 1, 2, 3 })
 			for (auto y : { 0, 1, 2, 3 })
 				ogreProjectionMatrix[eye][x][y] = oculusProjectionMatrix[eye].M[x][y];
 
+		//Culling is done from the custom matrix. A far distance of 0 tells Ogre the far plane is at infinity
+		stereoCameras[eye]->setNearClipDistance(nearClippingDistance);
+		stereoCameras[eye]->setFarClipDistance(reverseDepth ? 0 : farClippingDistance);
 		stereoCameras[eye]->setCustomProjectionMatrix(true, ogreProjectionMatrix[eye]);
 	}
 }
\ No newline at end of file
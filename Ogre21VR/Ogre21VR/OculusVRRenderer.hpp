@@ -6,6 +6,7 @@
 #include <OVR_CAPI.h>
 #include <OVR_CAPI_GL.h>
 #include <Extras/OVR_Math.h>
+#include <Extras/OVR_CAPI_Util.h>
 
 ///VRRenderer implementation for the Oculus Rift
 class OculusVRRenderer : public VRRenderer
@@ -23,33 +24,52 @@ public:
 	static Ogre::Quaternion oculusToOgreQuat(const ovrQuatf& q);
 	///Convert an Oculus Vector 3D to an Ogre Vector 3D
 	static Ogre::Vector3 oculusToOgreVect3(const ovrVector3f& v);
+	///Convert an Oculus pose state (pose and derivatives) to a backend independent pose
+	static VRPose oculusToVRPose(const ovrPoseStatef& poseState);
+	///Convert an Ogre quaternion to an Oculus Quaternion
+	static ovrQuatf ogreToOculusQuat(const Ogre::Quaternion& q);
+	///Convert an Ogre Vector 3D to an Oculus Vector 3D
+	static ovrVector3f ogreToOculusVect3(const Ogre::Vector3& v);
 	///Initialize the Oculus rendering
 	void initVRHardware() override;
 	///Get the projection matrix from the ovr rendering
 	void setCorrectProjectionMatrix() override;
 
+protected:
+	///Create the swapchain and the ovrLayer of an overlay layer
+	void initOverlayLayer(size_t layerIndex) override;
+
 private:
+	///Copy the freshly rendered overlay layers to their swapchains, and add them to the list of layers to submit
+	void submitOverlayLayers(ArenaVector<ovrLayerHeader*>& layerList);
+	///GPU memory of all the textures of a swapchain
+	size_t swapchainBytes(ovrTextureSwapChain swapchain, int width, int height, size_t bytesPerPixel) const;
+
 	ovrSession session;
 	ovrHmdDesc hmdDesc;
 	ovrGraphicsLuid luid;
 	ovrSizei bufferSize, hmdSize;
 	ovrMirrorTexture mirrorTexture;
-	ovrLayerEyeFov layer;
+	ovrLayerEyeFovDepth layer;
 	ovrTextureSwapChain textureSwapchain;
+	ovrTextureSwapChain depthSwapchain;
 	std::array<ovrVector3f, 2> offset;
 	ovrPosef pose;
 	ovrTrackingState ts;
+	ovrInputState inputState;
 	ovrLayerHeader* layers;
+	std::vector<ovrTextureSwapChain> overlaySwapchains;
+	std::vector<ovrLayer_Union> overlayOvrLayers;
 	ovrSessionStatus sessionStatus;
 	ovrEyeRenderDesc EyeRenderDesc[2];
 
 	double currentFrameDisplayTime;
 	unsigned long long frameCounter;
 	int currentIndex;
+	int currentDepthIndex;
+	unsigned int projectionFlags;
 
-	static constexpr const char* const rttTextureName{ "RTT_TEX_HMD_BUFFER" };
-
-	GLuint renderTextureGLID;
 	GLuint oculusRenderTextureGLID;
+	GLuint oculusDepthTextureGLID;
 	GLuint fbo;
 };
\ No newline at end of file
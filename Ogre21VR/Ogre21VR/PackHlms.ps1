@@ -0,0 +1,57 @@
+# Build step : pack every file under -Folder in -Pack, with their path relative to -Folder, for HlmsPackArchive to map.
+# Line endings are converted to '\n'. Layout, little endian :
+#   header : "HLMP", version, entry count, reserved
+#   one entry per template, sorted by name : name offset, name length, data offset, data length. Offsets are from the start of the file
+#   names, then the content of the templates
+param(
+	[string]$Folder = "HLMS",
+	[string]$Pack = "HLMS.hlmspack"
+)
+$ErrorActionPreference = "Stop"
+
+$root = (Resolve-Path $Folder).Path.TrimEnd('\')
+[string[]]$files = Get-ChildItem -Path $root -Recurse -File | ForEach-Object { $_.FullName.Substring($root.Length + 1).Replace('\', '/') }
+if (!$files) { throw "No HLMS template found in $Folder" }
+[Array]::Sort($files, [StringComparer]::Ordinal)
+
+$names = New-Object IO.MemoryStream
+$contents = New-Object IO.MemoryStream
+$entries = @()
+foreach ($file in $files)
+{
+	$name = [Text.Encoding]::UTF8.GetBytes($file)
+	#The HLMS parser doesn't care about '\r', no need to map it
+	$content = [Array]::FindAll([IO.File]::ReadAllBytes("$root\$file"), [Predicate[byte]]{ param($byte) $byte -ne 13 })
+
+	#Relative to their blob until the header size is known
+	$entries += , @($names.Length, $name.Length, $contents.Length, $content.Length)
+	$names.Write($name, 0, $name.Length)
+	$contents.Write($content, 0, $content.Length)
+}
+
+$namesStart = 16 + 16 * $entries.Count
+$contentsStart = $namesStart + $names.Length
+
+$writer = New-Object IO.BinaryWriter([IO.File]::Create($ExecutionContext.SessionState.Path.GetUnresolvedProviderPathFromPSPath($Pack)))
+try
+{
+	$writer.Write([byte[]][char[]]"HLMP")
+	$writer.Write([uint32]1)
+	$writer.Write([uint32]$entries.Count)
+	$writer.Write([uint32]0)
+	foreach ($entry in $entries)
+	{
+		$writer.Write([uint32]($namesStart + $entry[0]))
+		$writer.Write([uint32]$entry[1])
+		$writer.Write([uint32]($contentsStart + $entry[2]))
+		$writer.Write([uint32]$entry[3])
+	}
+	$writer.Write($names.ToArray())
+	$writer.Write($contents.ToArray())
+}
+finally
+{
+	$writer.Close()
+}
+
+Write-Output "Packed $($entries.Count) HLMS templates in $Pack"
@@ -0,0 +1,148 @@
+#include "PosePredictor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <OGRE/OgreMath.h>
+
+namespace
+{
+	///Quaternion of the rotation "rotation * length" around "rotation"
+	Ogre::Quaternion rotationVectorToQuaternion(const Ogre::Vector3& rotation)
+	{
+		const auto angle = rotation.length();
+		const auto halfAngle = angle * 0.5f;
+		//sin(a/2) / a tends to 1/2 when a tends to 0
+		const auto scale = angle > 1e-6f ? std::sin(halfAngle) / angle : 0.5f;
+		return Ogre::Quaternion{ std::cos(halfAngle), rotation.x * scale, rotation.y * scale, rotation.z * scale };
+	}
+}
+
+PosePredictor::PosePredictor() :
+	horizon{ 0 },
+	minCutoff{ 0 },
+	speedCoefficient{ 0 },
+	derivativeCutoff{ 1 },
+	hasPrevious{ false },
+	previousSample{},
+	previousFiltered{},
+	filteredLinearVelocity{ Ogre::Vector3::ZERO },
+	filteredAngularVelocity{ Ogre::Vector3::ZERO }
+{
+}
+
+void PosePredictor::setHorizon(double seconds)
+{
+	horizon = seconds;
+}
+
+void PosePredictor::setFiltering(Ogre::Real cutoff, Ogre::Real coefficient, Ogre::Real velocityCutoff)
+{
+	minCutoff = cutoff;
+	speedCoefficient = coefficient;
+	derivativeCutoff = velocityCutoff;
+}
+
+void PosePredictor::reset()
+{
+	hasPrevious = false;
+}
+
+VRPose PosePredictor::predict(const VRPose& input)
+{
+	auto sample = input;
+	if (!sample.hasDerivatives) deriveFromPrevious(sample);
+
+	auto filtered = sample;
+	if (minCutoff > 0 && hasPrevious)
+	{
+		const auto dt = Ogre::Real(std::max(1e-4, sample.timestamp - previousSample.timestamp));
+
+		//"One Euro" filter : heavy smoothing at rest where jitter shows, almost none when moving fast where lag shows.
+		//The speed opening the filter is low-passed too : raw velocities are as jittery as the poses they come from
+		const auto velocityFactor = smoothingFactor(derivativeCutoff, dt);
+		filteredLinearVelocity += (sample.linearVelocity - filteredLinearVelocity) * velocityFactor;
+		filteredAngularVelocity += (sample.angularVelocity - filteredAngularVelocity) * velocityFactor;
+
+		const auto positionFactor = smoothingFactor(minCutoff + speedCoefficient * filteredLinearVelocity.length(), dt);
+		filtered.position = previousFiltered.position + (sample.position - previousFiltered.position) * positionFactor;
+
+		const auto orientationFactor = smoothingFactor(minCutoff + speedCoefficient * filteredAngularVelocity.length(), dt);
+		filtered.orientation = Ogre::Quaternion::nlerp(orientationFactor, previousFiltered.orientation, sample.orientation, true);
+	}
+	else
+	{
+		filteredLinearVelocity = sample.linearVelocity;
+		filteredAngularVelocity = sample.angularVelocity;
+	}
+
+	previousSample = sample;
+	previousFiltered = filtered;
+	hasPrevious = true;
+
+	return horizon > 0 ? extrapolate(filtered, horizon) : filtered;
+}
+
+VRPose PosePredictor::extrapolate(const VRPose& pose, double dt)
+{
+	VRPose predicted;
+	extrapolate(&pose, &predicted, 1, dt);
+	return predicted;
+}
+
+void PosePredictor::extrapolate(const VRPose* poses, VRPose* predicted, size_t count, double dt)
+{
+	const auto t = Ogre::Real(dt);
+	const auto halfSquaredT = 0.5f * t * t;
+
+	for (size_t i{ 0 }; i < count; ++i)
+	{
+		const auto& pose = poses[i];
+		auto& out = predicted[i];
+
+		//Angular velocity is in tracking space, so the rotation is applied on the left
+		const auto rotation = pose.angularVelocity * t + pose.angularAcceleration * halfSquaredT;
+		out.orientation = rotationVectorToQuaternion(rotation) * pose.orientation;
+		out.orientation.normalise();
+
+		out.position = pose.position + pose.linearVelocity * t + pose.linearAcceleration * halfSquaredT;
+		out.angularVelocity = pose.angularVelocity + pose.angularAcceleration * t;
+		out.linearVelocity = pose.linearVelocity + pose.linearAcceleration * t;
+		out.angularAcceleration = pose.angularAcceleration;
+		out.linearAcceleration = pose.linearAcceleration;
+		out.timestamp = pose.timestamp + dt;
+		out.hasDerivatives = pose.hasDerivatives;
+	}
+}
+
+void PosePredictor::deriveFromPrevious(VRPose& sample) const
+{
+	//Second differences of a tracked pose are mostly noise, only the velocities are derived
+	sample.angularAcceleration = Ogre::Vector3::ZERO;
+	sample.linearAcceleration = Ogre::Vector3::ZERO;
+
+	const auto dt = hasPrevious ? sample.timestamp - previousSample.timestamp : 0;
+	if (dt <= 0)
+	{
+		sample.angularVelocity = hasPrevious ? previousSample.angularVelocity : Ogre::Vector3::ZERO;
+		sample.linearVelocity = hasPrevious ? previousSample.linearVelocity : Ogre::Vector3::ZERO;
+		return;
+	}
+
+	const auto invDt = Ogre::Real(1 / dt);
+	sample.linearVelocity = (sample.position - previousSample.position) * invDt;
+
+	//Rotation that brings the previous orientation to the current one, by the shortest path
+	auto delta = sample.orientation * previousSample.orientation.Inverse();
+	if (delta.w < 0) delta = -delta;
+
+	Ogre::Radian angle;
+	Ogre::Vector3 axis;
+	delta.ToAngleAxis(angle, axis);
+	sample.angularVelocity = axis * (angle.valueRadians() * invDt);
+}
+
+Ogre::Real PosePredictor::smoothingFactor(Ogre::Real cutoff, Ogre::Real dt)
+{
+	const auto tau = 1 / (Ogre::Math::TWO_PI * cutoff);
+	return 1 / (1 + tau / dt);
+}
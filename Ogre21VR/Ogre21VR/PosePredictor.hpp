@@ -0,0 +1,72 @@
+#pragma once
+
+//C++ standard libraries
+#include <cstddef>
+#include <cstdint>
+
+//Ogre 2 libraries
+#include <OGRE/OgreVector3.h>
+#include <OGRE/OgreQuaternion.h>
+
+///The tracked devices a pose can belong to
+enum class VRDevice : uint8_t
+{
+	Head,
+	LeftHand,
+	RightHand,
+	Count
+};
+
+///A tracked pose and its derivatives, in tracking space, as any backend can give it
+struct VRPose
+{
+	Ogre::Quaternion orientation;
+	Ogre::Vector3 position;
+	///Angular velocity in radians per second, expressed in tracking space
+	Ogre::Vector3 angularVelocity;
+	Ogre::Vector3 linearVelocity;
+	Ogre::Vector3 angularAcceleration;
+	Ogre::Vector3 linearAcceleration;
+	///Time of the sample in seconds
+	double timestamp;
+	///False when the backend only gives the pose. The predictor then derives the velocities from the previous samples
+	bool hasDerivatives;
+};
+
+///Filter the jitter out of a tracked pose and extrapolate it to the time the frame will be displayed
+class PosePredictor
+{
+public:
+	///Construct a predictor that does nothing : no prediction horizon and no filtering
+	PosePredictor();
+
+	///Set how far in the future the poses are extrapolated, in seconds
+	void setHorizon(double seconds);
+	///Enable the jitter filter. Cutoff frequency in Hz at rest, and how much it raises with speed. A minimal cutoff of 0 disables it.
+	///The speed is itself low-passed at "derivativeCutoff" Hz, so the jitter of the velocities doesn't open the filter
+	void setFiltering(Ogre::Real minCutoff, Ogre::Real speedCoefficient, Ogre::Real derivativeCutoff = 1);
+	///Forget the previous samples
+	void reset();
+
+	///Filter the sample with the previous ones, and extrapolate it by the horizon
+	VRPose predict(const VRPose& sample);
+
+	///Extrapolate a pose "dt" seconds in the future using its velocities and accelerations
+	static VRPose extrapolate(const VRPose& pose, double dt);
+	///Extrapolate "count" contiguous poses by the same "dt"
+	static void extrapolate(const VRPose* poses, VRPose* predicted, size_t count, double dt);
+
+private:
+	///Fill the velocities of a pose that don't have them from the last sample
+	void deriveFromPrevious(VRPose& sample) const;
+	///Smoothing factor of an exponential filter with that cutoff frequency, for a time step "dt"
+	static Ogre::Real smoothingFactor(Ogre::Real cutoff, Ogre::Real dt);
+
+	double horizon;
+	Ogre::Real minCutoff, speedCoefficient, derivativeCutoff;
+
+	bool hasPrevious;
+	VRPose previousSample, previousFiltered;
+	///Low-passed velocities of the samples, that open the filter
+	Ogre::Vector3 filteredLinearVelocity, filteredAngularVelocity;
+};
@@ -0,0 +1,79 @@
+#include "PoseRecorder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+constexpr uint32_t PoseRecorder::magic;
+constexpr uint32_t PoseRecorder::version;
+
+PoseRecorder::PoseRecorder(const std::string& path) :
+	file{ path, std::ios::binary | std::ios::trunc }
+{
+	if (!file) throw std::runtime_error("Cannot create the pose trace " + path);
+
+	file.write(reinterpret_cast<const char*>(&magic), sizeof magic);
+	file.write(reinterpret_cast<const char*>(&version), sizeof version);
+}
+
+void PoseRecorder::record(uint32_t frame, VRDevice device, const VRPose& pose)
+{
+	RecordedPose recorded{};
+	recorded.frame = frame;
+	recorded.device = uint8_t(device);
+	recorded.timestamp = pose.timestamp;
+	recorded.orientation[0] = pose.orientation.w;
+	recorded.orientation[1] = pose.orientation.x;
+	recorded.orientation[2] = pose.orientation.y;
+	recorded.orientation[3] = pose.orientation.z;
+	recorded.position[0] = pose.position.x;
+	recorded.position[1] = pose.position.y;
+	recorded.position[2] = pose.position.z;
+
+	file.write(reinterpret_cast<const char*>(&recorded), sizeof recorded);
+}
+
+PosePlayer::PosePlayer(const std::string& path)
+{
+	std::ifstream file{ path, std::ios::binary };
+	if (!file) throw std::runtime_error("Cannot open the pose trace " + path);
+
+	uint32_t fileMagic{ 0 }, fileVersion{ 0 };
+	file.read(reinterpret_cast<char*>(&fileMagic), sizeof fileMagic);
+	file.read(reinterpret_cast<char*>(&fileVersion), sizeof fileVersion);
+	if (fileMagic != PoseRecorder::magic || fileVersion != PoseRecorder::version)
+		throw std::runtime_error(path + " is not a pose trace this version can read");
+
+	RecordedPose recorded;
+	while (file.read(reinterpret_cast<char*>(&recorded), sizeof recorded))
+		poses.push_back(recorded);
+
+	//Written in order already, but keep the lookup valid for hand-edited traces
+	std::stable_sort(poses.begin(), poses.end(), [](const RecordedPose& a, const RecordedPose& b)
+	{
+		return a.frame < b.frame || (a.frame == b.frame && a.device < b.device);
+	});
+}
+
+bool PosePlayer::pose(uint32_t frame, VRDevice device, VRPose& pose) const
+{
+	const auto found = std::lower_bound(poses.begin(), poses.end(), std::make_pair(frame, uint8_t(device)),
+										[](const RecordedPose& a, const std::pair<uint32_t, uint8_t>& b)
+	{
+		return a.frame < b.first || (a.frame == b.first && a.device < b.second);
+	});
+	if (found == poses.end() || found->frame != frame || found->device != uint8_t(device)) return false;
+
+	pose.orientation = Ogre::Quaternion{ found->orientation[0], found->orientation[1], found->orientation[2], found->orientation[3] };
+	pose.position = Ogre::Vector3{ found->position[0], found->position[1], found->position[2] };
+	pose.angularVelocity = pose.linearVelocity = Ogre::Vector3::ZERO;
+	pose.angularAcceleration = pose.linearAcceleration = Ogre::Vector3::ZERO;
+	pose.timestamp = found->timestamp;
+	//The recorded poses are the ones that have been rendered, already filtered and predicted
+	pose.hasDerivatives = true;
+	return true;
+}
+
+bool PosePlayer::isFinished(uint32_t frame) const
+{
+	return poses.empty() || frame > poses.back().frame;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+//C++ standard libraries
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "PosePredictor.hpp"
+
+///One pose of a trace file, as it is stored on disk
+#pragma pack(push, 1)
+struct RecordedPose
+{
+	uint32_t frame;
+	uint8_t device;
+	uint8_t padding[3];
+	double timestamp;
+	///w, x, y, z
+	float orientation[4];
+	float position[3];
+};
+#pragma pack(pop)
+
+///Stream timestamped poses to a compact binary trace file
+class PoseRecorder
+{
+public:
+	///Create the trace file. Throw if it cannot be written
+	explicit PoseRecorder(const std::string& path);
+
+	///Append the pose of a device for this frame
+	void record(uint32_t frame, VRDevice device, const VRPose& pose);
+
+	///Magic number and version at the start of every trace file
+	static constexpr uint32_t magic{ 0x54505256 }; //"VRPT"
+	static constexpr uint32_t version{ 1 };
+
+private:
+	std::ofstream file;
+};
+
+///Read back a trace file and give the poses frame by frame
+class PosePlayer
+{
+public:
+	///Load the whole trace file. Throw if it's not a valid trace
+	explicit PosePlayer(const std::string& path);
+
+	///Get the pose of a device at that frame. Return false if the trace has none
+	bool pose(uint32_t frame, VRDevice device, VRPose& pose) const;
+	///Return true once "frame" is past the last frame of the trace
+	bool isFinished(uint32_t frame) const;
+
+private:
+	///Sorted by frame, then by device
+	std::vector<RecordedPose> poses;
+};
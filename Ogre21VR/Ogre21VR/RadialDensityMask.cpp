@@ -0,0 +1,186 @@
+#include "RadialDensityMask.hpp"
+
+#include <OGRE/Compositor/Pass/PassQuad/OgreCompositorPassQuadDef.h>
+#include <OGRE/Compositor/Pass/PassStencil/OgreCompositorPassStencilDef.h>
+#include <OGRE/OgreHighLevelGpuProgramManager.h>
+#include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+#include <OGRE/OgrePass.h>
+
+#include "StereoPostProcess.hpp"
+
+namespace
+{
+	const Ogre::String group{ Ogre::ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME };
+
+	const char* const fragmentHeader{ R"(#version 330
+in block { vec2 uv0; } inPs;
+out vec4 fragColour;
+uniform vec4 leftEyeFov;
+uniform vec4 rightEyeFov;
+uniform float radius;
+//Both the mask and the reconstruction decide from the same quad uv and pixel, so they always agree
+bool isMasked( vec2 uv, ivec2 pixel )
+{
+	//Tangents of the pixel's direction in its eye, divided by the ones of the viewport edge on its side
+	bool rightEye = uv.x >= 0.5;
+	vec4 fov = rightEye ? rightEyeFov : leftEyeFov;
+	vec2 eyeUv = vec2( uv.x * 2.0 - (rightEye ? 1.0 : 0.0), uv.y );
+	vec2 tangent = vec2( mix( -fov.x, fov.y, eyeUv.x ), mix( fov.z, -fov.w, eyeUv.y ) );
+	vec2 position = tangent / vec2( tangent.x < 0.0 ? fov.x : fov.y, tangent.y > 0.0 ? fov.z : fov.w );
+
+	//Whole 2x2 blocks, so the GPU never shades a pixel quad for a single pixel
+	ivec2 block = pixel / 2;
+	return length( position ) > radius && ((block.x + block.y) & 1) == 1;
+}
+)" };
+
+	const char* const maskProgram{ R"(
+void main()
+{
+	if( !isMasked( inPs.uv0, ivec2( gl_FragCoord.xy ) ) ) discard;
+	fragColour = vec4( 0.0 );
+}
+)" };
+
+	//The blocks left, right, above and below a masked one are shaded : interpolate between the nearest shaded pixels on each axis
+	const char* const reconstructProgram{ R"(
+uniform sampler2D hdr;
+//Clamped to the eye, a sample can land on a masked block : the next block inward is shaded
+ivec2 shadedSample( ivec2 candidate, ivec2 inward, ivec2 pixel, vec2 uvPerPixel, ivec2 minPixel, ivec2 maxPixel )
+{
+	ivec2 clamped = clamp( candidate, minPixel, maxPixel );
+	if( isMasked( inPs.uv0 + vec2( clamped - pixel ) * uvPerPixel, clamped ) )
+		clamped += inward * 2;
+	return clamped;
+}
+void main()
+{
+	//Derivatives are only defined before the branches
+	vec2 uvPerPixel = vec2( dFdx( inPs.uv0.x ), dFdy( inPs.uv0.y ) );
+	ivec2 pixel = ivec2( gl_FragCoord.xy );
+	if( !isMasked( inPs.uv0, pixel ) )
+	{
+		fragColour = texelFetch( hdr, pixel, 0 );
+		return;
+	}
+
+	ivec2 size = textureSize( hdr, 0 );
+	int eyeStart = inPs.uv0.x < 0.5 ? 0 : size.x / 2;
+	ivec2 minPixel = ivec2( eyeStart, 0 );
+	ivec2 maxPixel = ivec2( eyeStart + size.x / 2 - 1, size.y - 1 );
+
+	ivec2 inBlock = pixel & 1;
+	ivec2 left = shadedSample( ivec2( pixel.x - 1 - inBlock.x, pixel.y ), ivec2( 1, 0 ), pixel, uvPerPixel, minPixel, maxPixel );
+	ivec2 right = shadedSample( ivec2( pixel.x + 2 - inBlock.x, pixel.y ), ivec2( -1, 0 ), pixel, uvPerPixel, minPixel, maxPixel );
+	ivec2 below = shadedSample( ivec2( pixel.x, pixel.y - 1 - inBlock.y ), ivec2( 0, 1 ), pixel, uvPerPixel, minPixel, maxPixel );
+	ivec2 above = shadedSample( ivec2( pixel.x, pixel.y + 2 - inBlock.y ), ivec2( 0, -1 ), pixel, uvPerPixel, minPixel, maxPixel );
+	vec2 weight = (vec2( inBlock ) + 1.0) / 3.0;
+
+	vec4 horizontal = mix( texelFetch( hdr, left, 0 ), texelFetch( hdr, right, 0 ), weight.x );
+	vec4 vertical = mix( texelFetch( hdr, below, 0 ), texelFetch( hdr, above, 0 ), weight.y );
+	fragColour = 0.5 * (horizontal + vertical);
+}
+)" };
+}
+
+constexpr const char* const RadialDensityMask::maskMaterialName;
+constexpr const char* const RadialDensityMask::reconstructMaterialName;
+
+RadialDensityMask::RadialDensityMask(float maskRadius) :
+	radius{ maskRadius },
+	eyeFov{ { { 1, 1, 1, 1 }, { 1, 1, 1, 1 } } }
+{
+}
+
+void RadialDensityMask::createMaterials()
+{
+	if (!materials[0].isNull()) return;
+
+	auto& programManager = Ogre::HighLevelGpuProgramManager::getSingleton();
+	Ogre::HlmsMacroblock macroblock;
+	macroblock.mDepthCheck = false;
+	macroblock.mDepthWrite = false;
+	macroblock.mCullMode = Ogre::CULL_NONE;
+
+	const std::array<std::pair<const char*, const char*>, 2> programs{ { { maskMaterialName, maskProgram }, { reconstructMaterialName, reconstructProgram } } };
+	for (size_t i{ 0 }; i < programs.size(); ++i)
+	{
+		const Ogre::String name{ programs[i].first };
+		auto program = programManager.createProgram(name + "_ps", group, "glsl", Ogre::GPT_FRAGMENT_PROGRAM);
+		program->setSource(Ogre::String{ fragmentHeader } + programs[i].second);
+		program->load();
+
+		materials[i] = Ogre::MaterialManager::getSingleton().create(name, group);
+		auto pass = materials[i]->getTechnique(0)->getPass(0);
+		pass->setMacroblock(macroblock);
+		pass->setVertexProgram(StereoPostProcess::quadVertexProgramName);
+		pass->setFragmentProgram(program->getName());
+		materials[i]->load();
+	}
+
+	//The reconstruction reads texels one by one
+	Ogre::HlmsSamplerblock samplerblock;
+	samplerblock.mMinFilter = samplerblock.mMagFilter = Ogre::FO_POINT;
+	samplerblock.mMipFilter = Ogre::FO_NONE;
+	auto reconstructPass = materials[1]->getTechnique(0)->getPass(0);
+	reconstructPass->createTextureUnitState()->setSamplerblock(samplerblock);
+	reconstructPass->getFragmentProgramParameters()->setNamedConstant("hdr", 0);
+
+	updateMaterials();
+}
+
+void RadialDensityMask::setRadius(float maskRadius)
+{
+	radius = maskRadius;
+	updateMaterials();
+}
+
+void RadialDensityMask::setEyeFov(const std::array<VREyeFov, 2>& fov)
+{
+	eyeFov = fov;
+	updateMaterials();
+}
+
+void RadialDensityMask::updateMaterials() const
+{
+	for (const auto& material : materials)
+	{
+		if (material.isNull()) continue;
+
+		auto parameters = material->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+		parameters->setNamedConstant("leftEyeFov", Ogre::Vector4{ eyeFov[0].left, eyeFov[0].right, eyeFov[0].up, eyeFov[0].down });
+		parameters->setNamedConstant("rightEyeFov", Ogre::Vector4{ eyeFov[1].left, eyeFov[1].right, eyeFov[1].up, eyeFov[1].down });
+		parameters->setNamedConstant("radius", radius);
+	}
+}
+
+void RadialDensityMask::addMaskPasses(Ogre::CompositorTargetDef* targetDef)
+{
+	//Write "maskedStencil" wherever the mask quad doesn't discard
+	auto writeDef = static_cast<Ogre::CompositorPassStencilDef*>(targetDef->addPass(Ogre::PASS_STENCIL));
+	writeDef->mStencilRef = maskedStencil;
+	writeDef->mStencilParams.enabled = true;
+	writeDef->mStencilParams.stencilFront.compareOp = Ogre::CMPF_ALWAYS_PASS;
+	writeDef->mStencilParams.stencilFront.stencilPassOp = Ogre::SOP_REPLACE;
+	writeDef->mStencilParams.stencilBack = writeDef->mStencilParams.stencilFront;
+
+	//One quad over both eyes
+	auto quadDef = static_cast<Ogre::CompositorPassQuadDef*>(targetDef->addPass(Ogre::PASS_QUAD));
+	quadDef->mMaterialName = maskMaterialName;
+
+	//The scene passes only shade where the stencil is still clear. The test happens before the pixel shaders run
+	auto testDef = static_cast<Ogre::CompositorPassStencilDef*>(targetDef->addPass(Ogre::PASS_STENCIL));
+	testDef->mStencilRef = maskedStencil;
+	testDef->mStencilParams.enabled = true;
+	testDef->mStencilParams.stencilFront.compareOp = Ogre::CMPF_NOT_EQUAL;
+	testDef->mStencilParams.stencilFront.stencilPassOp = Ogre::SOP_KEEP;
+	testDef->mStencilParams.stencilBack = testDef->mStencilParams.stencilFront;
+}
+
+void RadialDensityMask::addStencilOffPass(Ogre::CompositorTargetDef* targetDef)
+{
+	//The stencil state would otherwise leak into the workspaces rendered next
+	auto offDef = static_cast<Ogre::CompositorPassStencilDef*>(targetDef->addPass(Ogre::PASS_STENCIL));
+	offDef->mStencilParams.enabled = false;
+}
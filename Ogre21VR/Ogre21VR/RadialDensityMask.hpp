@@ -0,0 +1,52 @@
+#pragma once
+
+//C++ standard libraries
+#include <array>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/Compositor/OgreCompositorNodeDef.h>
+
+///Field of view of an eye, as the tangents of its half angles from the center of projection. Asymmetric on most headsets
+struct VREyeFov
+{
+	float left, right, up, down;
+};
+
+///Radial density masking : past a radius, the eyes are only shaded in a checkerboard of 2x2 pixel blocks.
+///That's the periphery the lenses blur anyway. The mask is written to the stencil before the scene passes, which skip it,
+///and the masked blocks are filled in from their neighbours by the first pass of the post processing
+class RadialDensityMask
+{
+public:
+	///Material of the quad writing the mask to the stencil
+	static constexpr const char* const maskMaterialName{ "VRDensity/Mask" };
+	///Material filling the masked pixels in, reading the scene and writing a copy of it
+	static constexpr const char* const reconstructMaterialName{ "VRDensity/Reconstruct" };
+	///Stencil value of the pixels the scene passes don't shade
+	static constexpr Ogre::uint32 maskedStencil{ 1 };
+	///Passes added before the scene passes by addMaskPasses
+	static constexpr size_t maskPassCount{ 3 };
+
+	///Mask the pixels further than "radius" from the center of projection. 1 is the edge of the viewport, on each axis
+	explicit RadialDensityMask(float radius);
+
+	///Create the materials. Needs the vertex program of the post processing
+	void createMaterials();
+	void setRadius(float radius);
+	///Center the mask on the center of projection of each eye
+	void setEyeFov(const std::array<VREyeFov, 2>& fov);
+
+	///Add the passes writing the mask to the stencil, then enabling the stencil test for the passes that follow
+	static void addMaskPasses(Ogre::CompositorTargetDef* targetDef);
+	///Add the pass disabling the stencil test, after the scene passes
+	static void addStencilOffPass(Ogre::CompositorTargetDef* targetDef);
+
+private:
+	///Give the current settings to the materials
+	void updateMaterials() const;
+
+	float radius;
+	std::array<VREyeFov, 2> eyeFov;
+	std::array<Ogre::MaterialPtr, 2> materials;
+};
@@ -0,0 +1,302 @@
+#include "ShadowCache.hpp"
+#include "ClipControl.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <OGRE/Compositor/Pass/PassClear/OgreCompositorPassClearDef.h>
+#include <OGRE/Compositor/Pass/PassDepthCopy/OgreCompositorPassDepthCopyDef.h>
+#include <OGRE/Compositor/Pass/PassScene/OgreCompositorPassScene.h>
+#include <OGRE/Compositor/Pass/OgreCompositorPass.h>
+#include <OGRE/Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h>
+
+constexpr const char* const ShadowCache::shadowNodeName;
+constexpr Ogre::uint32 ShadowCache::dynamicCasterFlag;
+
+namespace
+{
+	///Below that, a turning light is not worth rendering the cached cascades again
+	const Ogre::Real lightDirectionTolerance{ 1e-3f };
+
+	///Identifier of the dynamic caster pass of cascade 0, the next ones follow
+	const Ogre::uint32 dynamicPassIdentifier{ 0x56520000 };
+
+	///Switches the clip space depth range between the passes of the shadow node and the others
+	class ClipRangeListener : public Ogre::CompositorWorkspaceListener
+	{
+	public:
+		ClipRangeListener() :
+			reverseDepth{ false },
+			shadowRange{ false }
+		{
+		}
+
+		void setReverseDepth(bool enabled)
+		{
+			//setClipDepthRange has just been called for the whole frame
+			reverseDepth = enabled;
+			shadowRange = false;
+		}
+
+		void passPreExecute(Ogre::CompositorPass* pass) override
+		{
+			if (!reverseDepth) return;
+
+			//The shadow node is updated inside the first eye scene pass, that fires this right after, before rendering
+			const bool shadowPass{ dynamic_cast<Ogre::CompositorShadowNode*>(pass->getParentNode()) != nullptr };
+			if (shadowPass == shadowRange) return;
+			shadowRange = shadowPass;
+			setClipDepthRange(!shadowRange);
+		}
+
+	private:
+		bool reverseDepth;
+		///The clip space is at [-1; 1] for now
+		bool shadowRange;
+	};
+}
+
+ShadowCache::ShadowCache(size_t cascades, Ogre::uint32 resolution, size_t firstCachedCascade) :
+	cascades{ Ogre::Math::Clamp<size_t>(cascades, 1, 4) },
+	resolution{ resolution },
+	firstCachedCascade{ firstCachedCascade },
+	light{ nullptr },
+	distanceThreshold{ 0.05f },
+	angleThreshold{ Ogre::Degree{ 5 } },
+	maxUpdatesPerFrame{ 1 },
+	lastUpdateCount{ 0 },
+	lastShadowNode{ nullptr },
+	workspaceListener{ std::make_unique<ClipRangeListener>() }
+{
+}
+
+ShadowCache::~ShadowCache() = default;
+
+void ShadowCache::createShadowNodeDef(Ogre::CompositorManager2* compositor) const
+{
+	if (compositor->hasShadowNodeDefinition(shadowNodeName)) return;
+
+	//The cached cascades have a static map more, rendered to before them
+	const auto cachedCascades = cascades - std::min(firstCachedCascade, cascades);
+	auto shadowNodeDef = compositor->addShadowNodeDefinition(shadowNodeName);
+	shadowNodeDef->setNumShadowTextureDefinitions(cascades);
+	shadowNodeDef->setNumLocalTextureDefinitions(cascades + cachedCascades);
+	shadowNodeDef->setNumTargetPass(cascades + cachedCascades);
+
+	const auto addDepthTexture = [&](const Ogre::String& name)
+	{
+		auto textureDef = shadowNodeDef->addTextureDefinition(name);
+		textureDef->width = resolution;
+		textureDef->height = resolution;
+		textureDef->formatList = { Ogre::PF_D32_FLOAT };
+	};
+
+	for (size_t i{ 0 }; i < cascades; ++i)
+	{
+		const auto textureName = "VRShadowCascade" + std::to_string(i);
+		addDepthTexture(textureName);
+
+		//Every cascade is a split of light 0, the first directional light
+		auto shadowTextureDef = shadowNodeDef->addShadowTextureDefinition(0, i, textureName, Ogre::Vector2::ZERO, Ogre::Vector2::UNIT_SCALE, 0);
+		shadowTextureDef->shadowMapTechnique = Ogre::SHADOWMAP_PSSM;
+		shadowTextureDef->numSplits = cascades;
+
+		//The passes that belong to the shadow map are skipped while it's a clean static one
+		if (i < firstCachedCascade)
+		{
+			auto targetDef = shadowNodeDef->addTargetPass(textureName);
+			targetDef->setNumPasses(2);
+			auto clearDef = static_cast<Ogre::CompositorPassClearDef*>(targetDef->addPass(Ogre::PASS_CLEAR));
+			clearDef->mShadowMapIdx = Ogre::uint32(i);
+			auto sceneDef = static_cast<Ogre::CompositorPassSceneDef*>(targetDef->addPass(Ogre::PASS_SCENE));
+			sceneDef->mShadowMapIdx = Ogre::uint32(i);
+			sceneDef->mIncludeOverlays = false;
+			continue;
+		}
+
+		const auto staticTextureName = "VRShadowCascadeStatic" + std::to_string(i);
+		addDepthTexture(staticTextureName);
+
+		auto staticTargetDef = shadowNodeDef->addTargetPass(staticTextureName);
+		staticTargetDef->setNumPasses(2);
+		auto clearDef = static_cast<Ogre::CompositorPassClearDef*>(staticTargetDef->addPass(Ogre::PASS_CLEAR));
+		clearDef->mShadowMapIdx = Ogre::uint32(i);
+		auto staticSceneDef = static_cast<Ogre::CompositorPassSceneDef*>(staticTargetDef->addPass(Ogre::PASS_SCENE));
+		staticSceneDef->mShadowMapIdx = Ogre::uint32(i);
+		staticSceneDef->mVisibilityMask = Ogre::VisibilityFlags::RESERVED_VISIBILITY_FLAGS & ~dynamicCasterFlag;
+		staticSceneDef->mIncludeOverlays = false;
+
+		//Not tied to the shadow map, so they run every frame. Their camera is given by bindDynamicPassCameras
+		auto targetDef = shadowNodeDef->addTargetPass(textureName);
+		targetDef->setNumPasses(2);
+		auto copyDef = static_cast<Ogre::CompositorPassDepthCopyDef*>(targetDef->addPass(Ogre::PASS_DEPTHCOPY));
+		copyDef->setDepthTextureCopy(staticTextureName, textureName);
+		auto dynamicSceneDef = static_cast<Ogre::CompositorPassSceneDef*>(targetDef->addPass(Ogre::PASS_SCENE));
+		dynamicSceneDef->mIdentifier = dynamicPassIdentifier + Ogre::uint32(i);
+		dynamicSceneDef->mVisibilityMask = dynamicCasterFlag;
+		dynamicSceneDef->mIncludeOverlays = false;
+	}
+}
+
+void ShadowCache::setLight(Ogre::Light* cachedLight)
+{
+	light = cachedLight;
+}
+
+void ShadowCache::setThresholds(Ogre::Real distanceFraction, Ogre::Radian angle)
+{
+	distanceThreshold = distanceFraction;
+	angleThreshold = angle;
+}
+
+void ShadowCache::setMaxUpdatesPerFrame(size_t count)
+{
+	maxUpdatesPerFrame = std::max<size_t>(1, count);
+}
+
+void ShadowCache::addDynamicCaster(Ogre::MovableObject* caster)
+{
+	//It was in the static maps until now
+	caster->addVisibilityFlags(dynamicCasterFlag);
+	invalidate();
+}
+
+void ShadowCache::removeDynamicCaster(Ogre::MovableObject* caster)
+{
+	caster->removeVisibilityFlags(dynamicCasterFlag);
+	invalidate();
+}
+
+void ShadowCache::invalidate()
+{
+	for (auto& shadowNode : shadowNodes)
+		for (auto& cascade : shadowNode.second.cascades)
+			cascade.valid = false;
+}
+
+void ShadowCache::bindDynamicPassCameras(Ogre::CompositorShadowNode* shadowNode) const
+{
+	//Ogre gives a pass the camera of its shadow map index, but a pass with one is also skipped while the map is clean
+	std::vector<Ogre::Camera*> cameras(cascades, nullptr);
+	for (auto pass : shadowNode->_getPasses())
+	{
+		const auto definition = pass->getDefinition();
+		if (definition->getType() == Ogre::PASS_SCENE && definition->mShadowMapIdx < cascades)
+			cameras[definition->mShadowMapIdx] = static_cast<Ogre::CompositorPassScene*>(pass)->getCamera();
+	}
+
+	for (auto pass : shadowNode->_getPasses())
+	{
+		const auto definition = pass->getDefinition();
+		if (definition->getType() != Ogre::PASS_SCENE || definition->mIdentifier < dynamicPassIdentifier) continue;
+		const auto i = size_t(definition->mIdentifier - dynamicPassIdentifier);
+		if (i >= cascades) continue;
+
+		auto scenePass = static_cast<Ogre::CompositorPassScene*>(pass);
+		scenePass->_setCustomCamera(cameras[i]);
+		scenePass->_setCustomCullCamera(cameras[i]);
+	}
+}
+
+bool ShadowCache::isDirty(const CachedCascade& cascade, const Ogre::Vector3& headPosition, const Ogre::Quaternion& headOrientation,
+						  const Ogre::Vector3& lightDirection, Ogre::Real reach) const
+{
+	return !cascade.valid
+		|| !cascade.lightDirection.positionEquals(lightDirection, lightDirectionTolerance)
+		|| cascade.headPosition.distance(headPosition) > distanceThreshold * reach
+		|| !cascade.headOrientation.equals(headOrientation, angleThreshold);
+}
+
+void ShadowCache::update(Ogre::CompositorShadowNode* shadowNode, const Ogre::Vector3& headPosition, const Ogre::Quaternion& headOrientation)
+{
+	lastUpdateCount = 0;
+	lastShadowNode = shadowNode;
+	if (!shadowNode || firstCachedCascade >= cascades) return;
+
+	//Fix the light to the cached cascades, or give them back to Ogre
+	auto& cache = shadowNodes[shadowNode];
+	if (cache.light != light || cache.cascades.empty())
+	{
+		cache.light = light;
+		if (cache.cascades.empty()) bindDynamicPassCameras(shadowNode);
+		cache.cascades.assign(cascades, CachedCascade{});
+		for (auto i = firstCachedCascade; i < cascades; ++i)
+			shadowNode->setLightFixedToShadowMap(i, light);
+	}
+	if (!light) return;
+
+	//Without the splits of last frame, the reach of the cascades is unknown : render them all
+	const auto splits = shadowNode->getPssmSplits(0);
+	const auto lightDirection = light->getDerivedDirectionUpdated();
+
+	//Nearest first : that's where a stale cascade is the most visible
+	for (auto i = firstCachedCascade; i < cascades; ++i)
+	{
+		auto& cascade = cache.cascades[i];
+		const auto reach = splits && splits->size() > i + 1 ? (*splits)[i + 1] : 0;
+		if (reach > 0 && !isDirty(cascade, headPosition, headOrientation, lightDirection, reach)) continue;
+		if (cascade.valid && reach > 0 && lastUpdateCount >= maxUpdatesPerFrame) continue;
+
+		shadowNode->setStaticShadowMapDirty(i, false);
+		if (cascade.valid) ++lastUpdateCount;
+
+		cascade.valid = reach > 0;
+		cascade.headPosition = headPosition;
+		cascade.headOrientation = headOrientation;
+		cascade.lightDirection = lightDirection;
+		cascade.reach = reach;
+	}
+}
+
+size_t ShadowCache::getLastUpdateCount() const
+{
+	return lastUpdateCount;
+}
+
+size_t ShadowCache::getShadowMapBytes() const
+{
+	const auto cachedCascades = cascades - std::min(firstCachedCascade, cascades);
+	return (cascades + cachedCascades) * Ogre::PixelUtil::getMemorySize(resolution, resolution, 1, Ogre::PF_D32_FLOAT);
+}
+
+void ShadowCache::setReverseDepth(bool enabled)
+{
+	static_cast<ClipRangeListener*>(workspaceListener.get())->setReverseDepth(enabled);
+}
+
+Ogre::CompositorWorkspaceListener* ShadowCache::getWorkspaceListener()
+{
+	return workspaceListener.get();
+}
+
+std::vector<ShadowCache::CascadeDepth> ShadowCache::readCascadeDepths() const
+{
+	std::vector<CascadeDepth> depths;
+	if (!lastShadowNode) return depths;
+
+	GLint previousTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+	std::vector<float> texels(size_t(resolution) * resolution);
+	for (size_t i{ 0 }; i < cascades; ++i)
+	{
+		GLuint glid{ 0 };
+		lastShadowNode->getDefinedTexture("VRShadowCascade" + std::to_string(i), 0)->getCustomAttribute("GLID", &glid);
+		glBindTexture(GL_TEXTURE_2D, glid);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, texels.data());
+
+		//The shadow maps are cleared to the far plane
+		size_t covered{ 0 };
+		double depthSum{ 0 };
+		for (auto texel : texels)
+			if (texel < 1)
+			{
+				++covered;
+				depthSum += texel;
+			}
+		depths.push_back({ float(covered) / float(texels.size()), covered ? float(depthSum / covered) : 1.0f });
+	}
+
+	glBindTexture(GL_TEXTURE_2D, GLuint(previousTexture));
+	return depths;
+}
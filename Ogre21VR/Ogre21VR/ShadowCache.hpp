@@ -0,0 +1,116 @@
+#pragma once
+#include <Windows.h>
+
+//OpenGL extension loading
+#include <GL/gl3w.h>
+
+//C++ standard libraries
+#include <map>
+#include <memory>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreLight.h>
+#include <OGRE/Compositor/OgreCompositorManager2.h>
+#include <OGRE/Compositor/OgreCompositorShadowNode.h>
+#include <OGRE/Compositor/OgreCompositorShadowNodeDef.h>
+#include <OGRE/Compositor/OgreCompositorWorkspaceListener.h>
+
+///PSSM shadows of the first directional light, computed once per frame for both eyes.
+///The near cascades are rendered every frame. The far ones render their static casters into an Ogre static shadow map, only
+///rendered again when the light turns or the head moves out of what it covers. Every frame, that depth is copied into the
+///cascade and the dynamic casters are drawn on top of it
+class ShadowCache
+{
+public:
+	///Name of the shadow node definition the eye passes use
+	static constexpr const char* const shadowNodeName{ "VRShadowNode" };
+	///Visibility flag of the dynamic casters. The cached static maps render everything else
+	static constexpr Ogre::uint32 dynamicCasterFlag{ 1u << 29 };
+
+	///Coverage of a cascade by the casters, read back from the GPU
+	struct CascadeDepth
+	{
+		///Fraction of the texels a caster has been rendered to
+		float coverage;
+		///Average depth of those texels
+		float averageDepth;
+	};
+
+	///"cascades" PSSM splits (up to 4, like the PBS shaders) of "resolution" pixels. The ones from "firstCachedCascade" on are cached
+	ShadowCache(size_t cascades, Ogre::uint32 resolution, size_t firstCachedCascade);
+	~ShadowCache();
+
+	///Create the shadow node definition, if it doesn't exist yet
+	void createShadowNodeDef(Ogre::CompositorManager2* compositor) const;
+
+	///Cache the far cascades of that light. It has to be the directional light Ogre picks first. nullptr renders every cascade every frame
+	void setLight(Ogre::Light* light);
+	///Render the cached cascades again if the head moves by more than "distanceFraction" of their reach, or turns by more than "angle"
+	void setThresholds(Ogre::Real distanceFraction, Ogre::Radian angle);
+	///At most that many cached cascades are rendered again in one frame, the nearest first. Never rendered ones don't count
+	void setMaxUpdatesPerFrame(size_t count);
+
+	///Casters that move. They get dynamicCasterFlag, and are drawn every frame over the cached static casters
+	void addDynamicCaster(Ogre::MovableObject* caster);
+	void removeDynamicCaster(Ogre::MovableObject* caster);
+	///Render all the cached cascades again, for example when static geometry has been added or removed
+	void invalidate();
+
+	///Mark the cached cascades of that shadow node that need to be rendered this frame. Call it once per frame, before rendering.
+	///There is one shadow node per eye buffer : each one keeps its own cascades
+	void update(Ogre::CompositorShadowNode* shadowNode, const Ogre::Vector3& headPosition, const Ogre::Quaternion& headOrientation);
+
+	///Number of cached cascades rendered again by the last update, not counting the first renders
+	size_t getLastUpdateCount() const;
+	///Size of the shadow maps of one shadow node
+	size_t getShadowMapBytes() const;
+
+	///The shadow cameras keep Ogre's [-1; 1] projections, that the PSSM receivers expect. With the reversed depth, the
+	///workspace listener puts the clip space back to [-1; 1] for the passes of the shadow node, and to [0; 1] after them
+	void setReverseDepth(bool enabled);
+	///Listener of the eye workspaces
+	Ogre::CompositorWorkspaceListener* getWorkspaceListener();
+
+	///Read back the cascades of the shadow node updated last. Waits for the GPU : for checks only
+	std::vector<CascadeDepth> readCascadeDepths() const;
+
+private:
+	///State of a cached cascade when it was last rendered
+	struct CachedCascade
+	{
+		bool valid;
+		Ogre::Vector3 headPosition;
+		Ogre::Quaternion headOrientation;
+		Ogre::Vector3 lightDirection;
+		///Far distance of the split
+		Ogre::Real reach;
+	};
+
+	///Cached cascades of one shadow node
+	struct ShadowNodeCache
+	{
+		Ogre::Light* light;
+		std::vector<CachedCascade> cascades;
+	};
+
+	///Give the dynamic caster passes the camera of the static map of their cascade
+	void bindDynamicPassCameras(Ogre::CompositorShadowNode* shadowNode) const;
+	///Return true if the cascade has to be rendered again
+	bool isDirty(const CachedCascade& cascade, const Ogre::Vector3& headPosition, const Ogre::Quaternion& headOrientation,
+				 const Ogre::Vector3& lightDirection, Ogre::Real reach) const;
+
+	const size_t cascades;
+	const Ogre::uint32 resolution;
+	const size_t firstCachedCascade;
+	Ogre::Light* light;
+	Ogre::Real distanceThreshold;
+	Ogre::Radian angleThreshold;
+	size_t maxUpdatesPerFrame;
+	size_t lastUpdateCount;
+
+	std::map<Ogre::CompositorShadowNode*, ShadowNodeCache> shadowNodes;
+	Ogre::CompositorShadowNode* lastShadowNode;
+	std::unique_ptr<Ogre::CompositorWorkspaceListener> workspaceListener;
+};
@@ -0,0 +1,335 @@
+#include "StereoLightGrid.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+constexpr GLuint StereoLightGrid::eyePassBinding;
+constexpr size_t StereoLightGrid::maxLights;
+constexpr size_t StereoLightGrid::texelsPerLight;
+constexpr size_t StereoLightGrid::eyePassSlots;
+
+namespace
+{
+	///Bytes of the ring a frame of the grid needs. With some room for the alignment of every allocation
+	size_t gridFrameBytes(size_t cellCount, size_t maxLights, size_t texelsPerLight, size_t eyePassSlots)
+	{
+		return cellCount * sizeof(Ogre::uint16) + maxLights * texelsPerLight * 4 * sizeof(float) + 2 * 4096
+			+ eyePassSlots * (sizeof(EyePassData) + 256);
+	}
+}
+
+StereoLightGrid::StereoLightGrid(Ogre::SceneNode* head, const std::array<Ogre::Camera*, 2>& eyeCameras,
+								 Ogre::uint32 width, Ogre::uint32 height, Ogre::uint32 numSlices, Ogre::uint32 lightsPerCell,
+								 float minDistance, float maxDistance) :
+	head{ head },
+	eyeCameras{ eyeCameras },
+	width{ std::max<Ogre::uint32>(1, width) },
+	height{ std::max<Ogre::uint32>(1, height) },
+	numSlices{ std::max<Ogre::uint32>(1, numSlices) },
+	lightsPerCell{ std::max<Ogre::uint32>(1, lightsPerCell) },
+	minDistance{ minDistance },
+	maxDistance{ std::max(minDistance + 1e-3f, maxDistance) },
+	sliceDistribution{ SliceDistribution::Linear },
+	gridView{ Ogre::Matrix4::IDENTITY },
+	tanLeft{ -1 },
+	tanRight{ 1 },
+	tanBottom{ -1 },
+	tanTop{ 1 },
+	apexOffset{ 0 },
+	cells(size_t(this->width) * this->height * this->numSlices * (this->lightsPerCell + 1), 0),
+	ring{ gridFrameBytes(cells.size(), maxLights, texelsPerLight, eyePassSlots), 3 },
+	cellsAllocation{},
+	lightsAllocation{},
+	eyeSlots{},
+	built{ false },
+	cellsTexture{ 0 },
+	lightsTexture{ 0 },
+	cellsUnit{ 0 },
+	lightsUnit{ 0 },
+	lastBuildMs{ 0 }
+{
+	gridLights.reserve(maxLights);
+	updateSliceDepths();
+
+	GLint maxUnits{ 0 };
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+	cellsUnit = GLuint(maxUnits - 2);
+	lightsUnit = GLuint(maxUnits - 1);
+
+	glGenTextures(1, &cellsTexture);
+	glGenTextures(1, &lightsTexture);
+}
+
+StereoLightGrid::~StereoLightGrid()
+{
+	glDeleteTextures(1, &cellsTexture);
+	glDeleteTextures(1, &lightsTexture);
+}
+
+void StereoLightGrid::setSliceDistribution(SliceDistribution distribution)
+{
+	sliceDistribution = distribution;
+	updateSliceDepths();
+}
+
+StereoLightGrid::SliceDistribution StereoLightGrid::getSliceDistribution() const
+{
+	return sliceDistribution;
+}
+
+void StereoLightGrid::beginFrame()
+{
+	ring.beginFrame();
+	cellsAllocation = lightsAllocation = FrameUploadRing::Allocation{};
+	built = false;
+}
+
+void StereoLightGrid::endFrame()
+{
+	ring.endFrame();
+}
+
+void StereoLightGrid::build(Ogre::SceneManager* sceneManager)
+{
+	const auto start = std::chrono::steady_clock::now();
+	updateFrustum();
+
+	Ogre::Matrix3 gridRotation;
+	gridView.extract3x3Matrix(gridRotation);
+
+	//The light list is written in sequence straight to the mapped memory, it's never read back
+	lightsAllocation = ring.allocate(maxLights * texelsPerLight * 4 * sizeof(float));
+	auto texel = static_cast<float*>(lightsAllocation.data);
+	const auto writeTexel = [&texel](Ogre::Real x, Ogre::Real y, Ogre::Real z, Ogre::Real w)
+	{
+		*texel++ = float(x);
+		*texel++ = float(y);
+		*texel++ = float(z);
+		*texel++ = float(w);
+	};
+
+	gridLights.clear();
+	for (auto light : sceneManager->getGlobalLightList().lights)
+	{
+		if (gridLights.size() == maxLights) break;
+		const auto type = light->getType();
+		if (type != Ogre::Light::LT_POINT && type != Ogre::Light::LT_SPOTLIGHT) continue;
+
+		const auto position = gridView * light->getParentNode()->_getDerivedPosition();
+		const auto range = light->getAttenuationRange();
+		gridLights.push_back({ position, range, Ogre::uint16(gridLights.size() * texelsPerLight) });
+
+		const auto diffuse = light->getDiffuseColour() * light->getPowerScale();
+		const auto specular = light->getSpecularColour() * light->getPowerScale();
+		const auto direction = gridRotation * light->getDerivedDirection();
+		const auto cosInner = Ogre::Math::Cos(light->getSpotlightInnerAngle() * 0.5f);
+		const auto cosOuter = Ogre::Math::Cos(light->getSpotlightOuterAngle() * 0.5f);
+
+		//Position and type, diffuse, specular, attenuation, spot direction and spot parameters. Like Forward3D
+		writeTexel(position.x, position.y, position.z, type == Ogre::Light::LT_POINT ? 1 : 2);
+		writeTexel(diffuse.r, diffuse.g, diffuse.b, 1);
+		writeTexel(specular.r, specular.g, specular.b, 1);
+		writeTexel(range, light->getAttenuationLinear(), light->getAttenuationQuadric(), 0);
+		writeTexel(direction.x, direction.y, direction.z, 0);
+		writeTexel(1 / std::max(cosInner - cosOuter, Ogre::Real(1e-4)), cosOuter, light->getSpotlightFalloff(), 0);
+	}
+
+	//One range of slices per worker thread. Each thread only writes its own slices, no locking needed
+	sceneManager->executeUserScalableTask(this, true);
+
+	cellsAllocation = ring.allocate(cells.size() * sizeof(Ogre::uint16));
+	std::memcpy(cellsAllocation.data, cells.data(), cells.size() * sizeof(Ogre::uint16));
+
+	//Both eyes are written at once, their passes only have to bind their slot
+	for (size_t eye{ 0 }; eye < 2; ++eye)
+	{
+		eyeSlots[eye] = ring.allocate(sizeof(EyePassData));
+		writeEyePass(eyeCameras[eye], eyeSlots[eye]);
+	}
+	built = true;
+
+	lastBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool StereoLightGrid::isBuilt() const
+{
+	return built;
+}
+
+void StereoLightGrid::bind(const Ogre::Camera* camera)
+{
+	if (!built) return;
+
+	if (camera == eyeCameras[0] || camera == eyeCameras[1])
+	{
+		ring.bind(eyePassBinding, eyeSlots[camera == eyeCameras[0] ? 0 : 1]);
+	}
+	else
+	{
+		//Monoscopic and overlay cameras get their own slot
+		const auto slot = ring.allocate(sizeof(EyePassData));
+		writeEyePass(camera, slot);
+		ring.bind(eyePassBinding, slot);
+	}
+
+	ring.bindTexture(cellsUnit, cellsTexture, GL_R16UI, cellsAllocation);
+	ring.bindTexture(lightsUnit, lightsTexture, GL_RGBA32F, lightsAllocation);
+}
+
+void StereoLightGrid::writeEyePass(const Ogre::Camera* camera, const FrameUploadRing::Allocation& allocation) const
+{
+	EyePassData data{};
+
+	//Ogre matrices are row major, GLSL ones are column major
+	const auto gridFromView = getGridFromView(camera).transpose();
+	for (size_t i{ 0 }; i < 16; ++i)
+		data.gridFromView[i] = float(gridFromView[0][i]);
+
+	const Ogre::Vector4 gridParams[]{ getProjection(), getDepthParams(), getSizeParams() };
+	float* gridVectors[]{ data.gridProjection, data.gridDepth, data.gridSize };
+	for (size_t v{ 0 }; v < 3; ++v)
+		for (size_t i{ 0 }; i < 4; ++i)
+			gridVectors[v][i] = float(gridParams[v][i]);
+
+	//Straight to the mapped memory, the driver never sees a copy
+	std::memcpy(allocation.data, &data, sizeof data);
+}
+
+void StereoLightGrid::execute(size_t threadId, size_t numThreads)
+{
+	const auto firstSlice = Ogre::uint32(numSlices * threadId / numThreads);
+	const auto endSlice = Ogre::uint32(numSlices * (threadId + 1) / numThreads);
+	const size_t cellStride{ lightsPerCell + 1u };
+	const auto sliceStride = size_t(width) * height * cellStride;
+	std::fill(cells.begin() + firstSlice * sliceStride, cells.begin() + endSlice * sliceStride, Ogre::uint16(0));
+
+	const auto projection = getProjection();
+	const auto cellX = [&](Ogre::Real tangent) { return Ogre::Math::Clamp<int>(int(std::floor(tangent * projection.x + projection.y)), 0, int(width) - 1); };
+	const auto cellY = [&](Ogre::Real tangent) { return Ogre::Math::Clamp<int>(int(std::floor(tangent * projection.z + projection.w)), 0, int(height) - 1); };
+
+	for (const auto& light : gridLights)
+	{
+		//Distance along the grid axis, from the apex
+		const auto depth = apexOffset - light.center.z;
+		const auto first = std::max(firstSlice, sliceAt(depth - light.radius));
+		const auto end = std::min(endSlice, sliceAt(depth + light.radius) + 1);
+
+		for (auto slice = first; slice < end; ++slice)
+		{
+			const auto nearDepth = std::max({ sliceDepths[slice], depth - light.radius, Ogre::Real(1e-3) });
+			const auto farDepth = std::min(sliceDepths[slice + 1], depth + light.radius);
+			if (nearDepth > farDepth) continue;
+
+			//Conservative tangents of the box around the sphere, over the depths of the slice it covers
+			const auto minTangent = [&](Ogre::Real v) { return v >= 0 ? v / farDepth : v / nearDepth; };
+			const auto maxTangent = [&](Ogre::Real v) { return v >= 0 ? v / nearDepth : v / farDepth; };
+			const auto left = minTangent(light.center.x - light.radius), right = maxTangent(light.center.x + light.radius);
+			const auto bottom = minTangent(light.center.y - light.radius), top = maxTangent(light.center.y + light.radius);
+			if (right < tanLeft || left > tanRight || top < tanBottom || bottom > tanTop) continue;
+
+			for (auto y = cellY(bottom); y <= cellY(top); ++y)
+				for (auto x = cellX(left); x <= cellX(right); ++x)
+				{
+					auto cell = &cells[slice * sliceStride + (size_t(y) * width + x) * cellStride];
+					if (cell[0] < lightsPerCell) cell[1 + cell[0]++] = light.index;
+				}
+		}
+	}
+}
+
+Ogre::uint32 StereoLightGrid::sliceAt(Ogre::Real depth) const
+{
+	auto t = Ogre::Math::Clamp<Ogre::Real>((depth - minDistance) / (maxDistance - minDistance), 0, 1);
+	if (sliceDistribution == SliceDistribution::Exponential)
+		t = 1 - std::pow(1 - t, Ogre::Real(8));
+	return Ogre::uint32(std::floor(t * (numSlices - 1)));
+}
+
+void StereoLightGrid::updateSliceDepths()
+{
+	//Inverse of sliceAt. The first slice goes down to the apex, the last one to infinity
+	sliceDepths.resize(numSlices + 1);
+	sliceDepths.front() = 0;
+	sliceDepths.back() = std::numeric_limits<Ogre::Real>::max();
+	for (Ogre::uint32 slice{ 1 }; slice < numSlices; ++slice)
+	{
+		auto t = Ogre::Real(slice) / (numSlices - 1);
+		if (sliceDistribution == SliceDistribution::Exponential)
+			t = 1 - std::pow(1 - t, Ogre::Real(1) / 8);
+		sliceDepths[slice] = minDistance + t * (maxDistance - minDistance);
+	}
+}
+
+void StereoLightGrid::updateFrustum()
+{
+	gridView = head->_getFullTransform().inverseAffine();
+
+	tanLeft = tanBottom = std::numeric_limits<Ogre::Real>::max();
+	tanRight = tanTop = std::numeric_limits<Ogre::Real>::lowest();
+	for (auto camera : eyeCameras)
+	{
+		Ogre::Real left, right, top, bottom;
+		camera->getFrustumExtents(left, right, top, bottom);
+		const auto nearDistance = camera->getNearClipDistance();
+		tanLeft = std::min(tanLeft, left / nearDistance);
+		tanRight = std::max(tanRight, right / nearDistance);
+		tanBottom = std::min(tanBottom, bottom / nearDistance);
+		tanTop = std::max(tanTop, top / nearDistance);
+	}
+
+	//The eyes are off center. Pull the apex back until both eye positions are inside the union of the frustums,
+	//then each eye frustum, narrower than the union, is inside too
+	apexOffset = 0;
+	for (auto camera : eyeCameras)
+	{
+		const auto eye = camera->getPosition();
+		const auto requiredDepth = std::max(eye.x < 0 ? eye.x / tanLeft : eye.x / tanRight,
+											eye.y < 0 ? eye.y / tanBottom : eye.y / tanTop);
+		apexOffset = std::max(apexOffset, requiredDepth + eye.z);
+	}
+}
+
+Ogre::Matrix4 StereoLightGrid::getGridFromView(const Ogre::Camera* camera) const
+{
+	return gridView * camera->getViewMatrix(true).inverseAffine();
+}
+
+Ogre::Vector4 StereoLightGrid::getProjection() const
+{
+	const auto scaleX = width / (tanRight - tanLeft);
+	const auto scaleY = height / (tanTop - tanBottom);
+	return { scaleX, -tanLeft * scaleX, scaleY, -tanBottom * scaleY };
+}
+
+Ogre::Vector4 StereoLightGrid::getDepthParams() const
+{
+	return { minDistance, 1 / (maxDistance - minDistance), Ogre::Real(numSlices - 1), Ogre::Real(lightsPerCell) };
+}
+
+Ogre::Vector4 StereoLightGrid::getSizeParams() const
+{
+	return { Ogre::Real(width), Ogre::Real(height), apexOffset, 0 };
+}
+
+GLuint StereoLightGrid::getCellsUnit() const
+{
+	return cellsUnit;
+}
+
+GLuint StereoLightGrid::getLightsUnit() const
+{
+	return lightsUnit;
+}
+
+size_t StereoLightGrid::getUploadBytes() const
+{
+	return ring.getCapacity();
+}
+
+double StereoLightGrid::getLastBuildMs() const
+{
+	return lastBuildMs;
+}
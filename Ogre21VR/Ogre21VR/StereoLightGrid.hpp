@@ -0,0 +1,133 @@
+#pragma once
+
+//C++ standard libraries
+#include <array>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreLight.h>
+#include <OGRE/Threading/OgreUniformScalableTask.h>
+
+#include "FrameUploadRing.hpp"
+
+///Grid parameters of one camera, as declared by the EyePassBuffer block of the PBS templates (std140). Column major
+struct EyePassData
+{
+	float gridFromView[16];
+	float gridProjection[4];
+	float gridDepth[4];
+	float gridSize[4];
+};
+
+///Clustered light grid built once per frame for both eyes. Like Ogre's Forward3D, but in head space instead of one eye view space.
+///The grid frustum is the union of the eye frustums, with its apex pulled back behind the eyes so it contains both
+class StereoLightGrid : public Ogre::UniformScalableTask
+{
+public:
+	///How the slices are spread between the min and max distances
+	enum class SliceDistribution
+	{
+		///Same depth for every slice, like the Forward3D shader
+		Linear,
+		///Thin slices close to the eyes, where a light covers the most pixels
+		Exponential
+	};
+
+	///Binding point of the EyePassBuffer block. 0 to 2 are used by the HLMS itself
+	static constexpr GLuint eyePassBinding{ 4 };
+
+	///Same parameters as SceneManager::setForward3D. "head" is the node the eye cameras are attached to
+	StereoLightGrid(Ogre::SceneNode* head, const std::array<Ogre::Camera*, 2>& eyeCameras,
+					Ogre::uint32 width, Ogre::uint32 height, Ogre::uint32 numSlices, Ogre::uint32 lightsPerCell,
+					float minDistance, float maxDistance);
+	~StereoLightGrid();
+
+	///Choose how the slices are spread. Linear by default
+	void setSliceDistribution(SliceDistribution distribution);
+	SliceDistribution getSliceDistribution() const;
+
+	///Start a frame of the upload ring of the grid
+	void beginFrame();
+	///Fence the grid of this frame
+	void endFrame();
+
+	///Assign the point and spot lights of the scene to the cells, on the scene manager worker threads, and upload the grid
+	///with the grid parameters of both eyes. Needs the global light list of this frame : call it once the scene graph is updated,
+	///when the first eye is rendered
+	void build(Ogre::SceneManager* sceneManager);
+	///Return true once the grid of this frame is built
+	bool isBuilt() const;
+	///Bind the cells and the lights to their texture units, and the grid parameters of "camera" to eyePassBinding.
+	///The eyes use the ones uploaded by build, the other cameras get theirs uploaded here
+	void bind(const Ogre::Camera* camera);
+
+	///Transform from the view space of "camera" to the grid space
+	Ogre::Matrix4 getGridFromView(const Ogre::Camera* camera) const;
+	///Tangent to cell : x scale, x offset, y scale, y offset
+	Ogre::Vector4 getProjection() const;
+	///Min distance, 1 / depth range, slice count - 1, lights per cell
+	Ogre::Vector4 getDepthParams() const;
+	///Width, height, distance of the apex behind the head, unused
+	Ogre::Vector4 getSizeParams() const;
+
+	///Texture units of the cells and the lights. The last two units, the HLMS starts from the first ones
+	GLuint getCellsUnit() const;
+	GLuint getLightsUnit() const;
+	///Size of the upload ring the cells, the lights and the grid parameters are written to
+	size_t getUploadBytes() const;
+	///Time the last build took, in milliseconds
+	double getLastBuildMs() const;
+
+	///Fill the slices of a worker thread
+	void execute(size_t threadId, size_t numThreads) override;
+
+private:
+	///Bounding sphere of a light, in grid space
+	struct GridLight
+	{
+		Ogre::Vector3 center;
+		Ogre::Real radius;
+		Ogre::uint16 index;
+	};
+
+	///Slice a distance along the grid axis falls in. Same math as the shader
+	Ogre::uint32 sliceAt(Ogre::Real depth) const;
+	///Fill the depth at which each slice starts
+	void updateSliceDepths();
+	///Fit the grid frustum around the eye frustums
+	void updateFrustum();
+	///Write the grid parameters of a camera to an allocation of the ring
+	void writeEyePass(const Ogre::Camera* camera, const FrameUploadRing::Allocation& allocation) const;
+
+	Ogre::SceneNode* head;
+	std::array<Ogre::Camera*, 2> eyeCameras;
+	const Ogre::uint32 width, height, numSlices, lightsPerCell;
+	const float minDistance, maxDistance;
+	SliceDistribution sliceDistribution;
+	///Depth at which each slice starts, and infinity at the end. The first slice starts at the apex
+	std::vector<Ogre::Real> sliceDepths;
+
+	Ogre::Matrix4 gridView;
+	Ogre::Real tanLeft, tanRight, tanBottom, tanTop;
+	Ogre::Real apexOffset;
+
+	std::vector<GridLight> gridLights;
+	///Light count followed by "lightsPerCell" light offsets, for each cell
+	std::vector<Ogre::uint16> cells;
+
+	FrameUploadRing ring;
+	FrameUploadRing::Allocation cellsAllocation, lightsAllocation;
+	std::array<FrameUploadRing::Allocation, 2> eyeSlots;
+	bool built;
+	GLuint cellsTexture, lightsTexture;
+	GLuint cellsUnit, lightsUnit;
+	double lastBuildMs;
+
+	///Lights beyond that are ignored. Offsets are stored on 16 bits
+	static constexpr size_t maxLights{ 1024 };
+	///vec4 per light in the light list, same layout as Forward3D
+	static constexpr size_t texelsPerLight{ 6 };
+	///Grid parameters a frame can upload : both eyes, then the monoscopic and overlay cameras
+	static constexpr size_t eyePassSlots{ 32 };
+};
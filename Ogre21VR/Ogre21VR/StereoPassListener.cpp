@@ -0,0 +1,100 @@
+#include "StereoPassListener.hpp"
+
+#include <cstring>
+
+StereoPassListener::StereoPassListener() :
+	nextListener{ nullptr },
+	lightGrid{ nullptr },
+	forward3DSliceTable{ true }
+{
+}
+
+void StereoPassListener::setNextListener(Ogre::HlmsListener* listener)
+{
+	nextListener = listener;
+}
+
+void StereoPassListener::setLightGrid(StereoLightGrid* grid)
+{
+	lightGrid = grid;
+}
+
+void StereoPassListener::setForward3DSliceTable(bool enabled)
+{
+	forward3DSliceTable = enabled;
+}
+
+Ogre::uint32 StereoPassListener::sliceTableSize(bool casterPass, Ogre::SceneManager* sceneManager) const
+{
+	if (casterPass || !forward3DSliceTable) return 0;
+	const auto forward3D = sceneManager->getForward3D();
+	return forward3D ? (forward3D->getNumSlices() + 3) / 4 : 0;
+}
+
+void StereoPassListener::shaderCacheEntryCreated(const Ogre::String& shaderProfile, const Ogre::HlmsCache* hlmsCacheEntry,
+												 const Ogre::HlmsCache& passCache, const Ogre::HlmsPropertyVec& properties,
+												 const Ogre::QueuedRenderable& queuedRenderable)
+{
+	if (nextListener) nextListener->shaderCacheEntryCreated(shaderProfile, hlmsCacheEntry, passCache, properties, queuedRenderable);
+}
+
+void StereoPassListener::preparePassHash(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+										 Ogre::SceneManager* sceneManager, Ogre::Hlms* hlms)
+{
+	//Same values for every camera, so both eyes still share their shaders
+	if (!casterPass)
+	{
+		if (const auto tableSize = sliceTableSize(casterPass, sceneManager))
+			hlms->_setProperty("vr_f3d_slice_table", Ogre::int32(tableSize));
+		if (lightGrid)
+		{
+			hlms->_setProperty("vr_stereo_grid", 1);
+			hlms->_setProperty("vr_stereo_grid_cells_unit", Ogre::int32(lightGrid->getCellsUnit()));
+			hlms->_setProperty("vr_stereo_grid_lights_unit", Ogre::int32(lightGrid->getLightsUnit()));
+			if (lightGrid->getSliceDistribution() == StereoLightGrid::SliceDistribution::Exponential)
+				hlms->_setProperty("vr_stereo_grid_exponential", 1);
+		}
+	}
+	if (nextListener) nextListener->preparePassHash(shadowNode, casterPass, dualParaboloid, sceneManager, hlms);
+}
+
+Ogre::uint32 StereoPassListener::getPassBufferSize(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+												   Ogre::SceneManager* sceneManager) const
+{
+	const Ogre::uint32 tableBytes{ sliceTableSize(casterPass, sceneManager) * 4 * sizeof(Ogre::uint32) };
+	return tableBytes + (nextListener ? nextListener->getPassBufferSize(shadowNode, casterPass, dualParaboloid, sceneManager) : 0);
+}
+
+float* StereoPassListener::preparePassBuffer(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+											 Ogre::SceneManager* sceneManager, float* passBufferPtr)
+{
+	if (!casterPass)
+	{
+		//The grid is built the first time an eye is rendered, the other passes only bind it
+		if (lightGrid)
+		{
+			if (!lightGrid->isBuilt()) lightGrid->build(sceneManager);
+			lightGrid->bind(sceneManager->getCameraInProgress());
+		}
+
+		//Each Forward3D slice has twice the resolution of the previous one : 4 times the cells
+		if (const auto tableSize = sliceTableSize(casterPass, sceneManager))
+		{
+			const auto forward3D = sceneManager->getForward3D();
+			const Ogre::uint32 cellsPerTableOnGrid0{ forward3D->getWidth() * forward3D->getHeight() * forward3D->getLightsPerCell() };
+			for (Ogre::uint32 slice{ 0 }; slice < tableSize * 4; ++slice)
+			{
+				//The table is padded to a whole uvec4
+				const Ogre::uint32 offset{ slice < forward3D->getNumSlices() ? cellsPerTableOnGrid0 * (((1u << (slice << 1u)) - 1u) / 3u) : 0u };
+				std::memcpy(passBufferPtr++, &offset, sizeof offset);
+			}
+		}
+	}
+
+	return nextListener ? nextListener->preparePassBuffer(shadowNode, casterPass, dualParaboloid, sceneManager, passBufferPtr) : passBufferPtr;
+}
+
+void StereoPassListener::hlmsTypeChanged(bool casterPass, Ogre::CommandBuffer* commandBuffer, const Ogre::HlmsDatablock* datablock)
+{
+	if (nextListener) nextListener->hlmsTypeChanged(casterPass, commandBuffer, datablock);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreHlms.h>
+#include <OGRE/OgreHlmsListener.h>
+#include <OGRE/OgreForward3D.h>
+
+#include "StereoLightGrid.hpp"
+
+///HLMS listener building the stereo light grid when the first eye is rendered, and binding it with the grid parameters of the camera
+///of each pass. An Hlms has a single listener, so a custom one can be chained behind this one
+class StereoPassListener : public Ogre::HlmsListener
+{
+public:
+	StereoPassListener();
+
+	///Forward every call to "listener" too. Pass nullptr to remove it
+	void setNextListener(Ogre::HlmsListener* listener);
+	///Shade point and spot lights with this grid, built when the first eye is rendered. Pass nullptr to disable it
+	void setLightGrid(StereoLightGrid* grid);
+	///Give the Forward3D shader the cell offset of each slice in the pass buffer, instead of computing it per pixel. On by default
+	void setForward3DSliceTable(bool enabled);
+
+	void shaderCacheEntryCreated(const Ogre::String& shaderProfile, const Ogre::HlmsCache* hlmsCacheEntry,
+								 const Ogre::HlmsCache& passCache, const Ogre::HlmsPropertyVec& properties,
+								 const Ogre::QueuedRenderable& queuedRenderable) override;
+	void preparePassHash(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+						 Ogre::SceneManager* sceneManager, Ogre::Hlms* hlms) override;
+	Ogre::uint32 getPassBufferSize(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+								   Ogre::SceneManager* sceneManager) const override;
+	float* preparePassBuffer(const Ogre::CompositorShadowNode* shadowNode, bool casterPass, bool dualParaboloid,
+							 Ogre::SceneManager* sceneManager, float* passBufferPtr) override;
+	void hlmsTypeChanged(bool casterPass, Ogre::CommandBuffer* commandBuffer, const Ogre::HlmsDatablock* datablock) override;
+
+private:
+	///Number of uvec4 of the Forward3D slice table in the pass buffer. 0 when there is none
+	Ogre::uint32 sliceTableSize(bool casterPass, Ogre::SceneManager* sceneManager) const;
+
+	Ogre::HlmsListener* nextListener;
+	StereoLightGrid* lightGrid;
+	bool forward3DSliceTable;
+};
@@ -0,0 +1,412 @@
+#include "StereoPostProcess.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include <OGRE/Compositor/Pass/PassQuad/OgreCompositorPassQuadDef.h>
+#include <OGRE/OgreHighLevelGpuProgramManager.h>
+#include <OGRE/OgreMaterialManager.h>
+#include <OGRE/OgreTechnique.h>
+#include <OGRE/OgrePass.h>
+
+#include "HiddenAreaMesh.hpp"
+
+namespace
+{
+	const Ogre::String group{ Ogre::ResourceGroupManager::INTERNAL_RESOURCE_GROUP_NAME };
+
+	const char* const quadVertexProgram{ R"(#version 330
+in vec4 vertex;
+in vec2 uv0;
+uniform mat4 worldViewProj;
+out gl_PerVertex { vec4 gl_Position; };
+out block { vec2 uv0; } outVs;
+void main()
+{
+	gl_Position = worldViewProj * vertex;
+	outVs.uv0 = uv0;
+}
+)" };
+
+	const char* const fragmentHeader{ R"(#version 330
+in block { vec2 uv0; } inPs;
+out vec4 fragColour;
+const vec3 lumaWeights = vec3( 0.2126, 0.7152, 0.0722 );
+//Both eyes are side by side : keep a sample in the half of the texture it started in
+vec2 clampToEye( vec2 uv, vec2 texel )
+{
+	float eyeStart = inPs.uv0.x < 0.5 ? 0.0 : 0.5;
+	return clamp( uv, vec2( eyeStart + texel.x * 0.5, 0.0 ), vec2( eyeStart + 0.5 - texel.x * 0.5, 1.0 ) );
+}
+)" };
+
+	const std::vector<std::pair<const char*, const char*>> fragmentPrograms
+	{
+		//Four taps under the output texel, whatever the reduction ratio. Green is the weight of the texel, zeroed where the lenses show nothing
+		{ "VRPost/LogLuminance_ps", R"(
+uniform sampler2D hdr;
+float logLuminance( vec2 uv )
+{
+	return log( max( dot( texture( hdr, uv ).rgb, lumaWeights ), 0.0001 ) );
+}
+void main()
+{
+	vec2 quarter = 0.25 * abs( vec2( dFdx( inPs.uv0.x ), dFdy( inPs.uv0.y ) ) );
+	fragColour = vec4( 0.25 * ( logLuminance( inPs.uv0 + vec2( -quarter.x, -quarter.y ) ) +
+								logLuminance( inPs.uv0 + vec2( quarter.x, -quarter.y ) ) +
+								logLuminance( inPs.uv0 + vec2( -quarter.x, quarter.y ) ) +
+								logLuminance( inPs.uv0 + vec2( quarter.x, quarter.y ) ) ), 1.0, 0.0, 0.0 );
+}
+)" },
+		//Weighted average of the 4x4 source texels of each output texel, and their average weight. The last level is smaller than that
+		{ "VRPost/LuminanceReduce_ps", R"(
+uniform sampler2D source;
+void main()
+{
+	ivec2 size = textureSize( source, 0 );
+	ivec2 first = ivec2( gl_FragCoord.xy ) * 4;
+	float sum = 0.0, weight = 0.0, count = 0.0;
+	for( int y = 0; y < 4; ++y )
+		for( int x = 0; x < 4; ++x )
+		{
+			ivec2 texel = first + ivec2( x, y );
+			if( texel.x < size.x && texel.y < size.y )
+			{
+				vec2 value = texelFetch( source, texel, 0 ).rg;
+				sum += value.r * value.g;
+				weight += value.g;
+				count += 1.0;
+			}
+		}
+	fragColour = vec4( sum / max( weight, 0.0001 ), weight / max( count, 1.0 ), 0.0, 0.0 );
+}
+)" },
+		{ "VRPost/Adapt_ps", R"(
+uniform sampler2D averageLogLuminance;
+uniform sampler2D adaptedLuminance;
+uniform float frameTime;
+uniform float adaptationSpeed;
+void main()
+{
+	float target = exp( texelFetch( averageLogLuminance, ivec2( 0 ), 0 ).r );
+	float previous = texelFetch( adaptedLuminance, ivec2( 0 ), 0 ).r;
+	//The texture starts uninitialised : start from the scene as it is
+	if( !(previous > 0.0 && previous < 1e20) ) previous = target;
+	fragColour = vec4( previous + (target - previous) * (1.0 - exp( -frameTime * adaptationSpeed )) );
+}
+)" },
+		{ "VRPost/Copy_ps", R"(
+uniform sampler2D source;
+void main()
+{
+	fragColour = texelFetch( source, ivec2( gl_FragCoord.xy ), 0 );
+}
+)" },
+		//Half resolution : one bilinear tap is the average of the 2x2 texels under the output texel
+		{ "VRPost/BrightPass_ps", R"(
+uniform sampler2D hdr;
+uniform sampler2D adaptedLuminance;
+uniform float keyValue;
+uniform float bloomThreshold;
+void main()
+{
+	float exposure = keyValue / max( texelFetch( adaptedLuminance, ivec2( 0 ), 0 ).r, 0.0001 );
+	fragColour = vec4( max( texture( hdr, inPs.uv0 ).rgb * exposure - bloomThreshold, 0.0 ), 1.0 );
+}
+)" },
+		//9 tap gaussian in 5 bilinear taps
+		{ "VRPost/Blur_ps", R"(
+uniform sampler2D source;
+uniform vec2 direction;
+void main()
+{
+	const float offsets[3] = float[]( 0.0, 1.3846153846, 3.2307692308 );
+	const float weights[3] = float[]( 0.2270270270, 0.3162162162, 0.0702702703 );
+	vec2 texel = 1.0 / vec2( textureSize( source, 0 ) );
+	vec3 sum = texture( source, inPs.uv0 ).rgb * weights[0];
+	for( int i = 1; i < 3; ++i )
+	{
+		vec2 offset = direction * texel * offsets[i];
+		sum += texture( source, clampToEye( inPs.uv0 + offset, texel ) ).rgb * weights[i];
+		sum += texture( source, clampToEye( inPs.uv0 - offset, texel ) ).rgb * weights[i];
+	}
+	fragColour = vec4( sum, 1.0 );
+}
+)" },
+		{ "VRPost/ToneMap_ps", R"(
+uniform sampler2D hdr;
+uniform sampler2D bloom;
+uniform sampler2D adaptedLuminance;
+uniform float keyValue;
+uniform float bloomStrength;
+uniform vec3 lift;
+uniform vec3 gamma;
+uniform vec3 gain;
+uniform float saturation;
+//ACES filmic curve, Narkowicz's fit
+vec3 toneMap( vec3 x )
+{
+	return clamp( (x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0 );
+}
+void main()
+{
+	float exposure = keyValue / max( texelFetch( adaptedLuminance, ivec2( 0 ), 0 ).r, 0.0001 );
+	vec2 bloomTexel = 1.0 / vec2( textureSize( bloom, 0 ) );
+	vec3 colour = toneMap( texture( hdr, inPs.uv0 ).rgb * exposure +
+						   texture( bloom, clampToEye( inPs.uv0, bloomTexel ) ).rgb * bloomStrength );
+
+	colour = pow( max( gain * (colour + lift * (1.0 - colour)), 0.0 ), 1.0 / gamma );
+	colour = clamp( mix( vec3( dot( colour, lumaWeights ) ), colour, saturation ), 0.0, 1.0 );
+
+	//The eye buffer is copied as it is to an sRGB swapchain
+	vec3 srgb = mix( colour * 12.92, 1.055 * pow( colour, vec3( 1.0 / 2.4 ) ) - 0.055, step( 0.0031308, colour ) );
+	fragColour = vec4( srgb, 1.0 );
+}
+)" },
+	};
+
+	struct QuadMaterial
+	{
+		const char* name;
+		const char* fragmentProgram;
+		std::vector<const char*> samplers;
+		///Bilinear filtering, for the passes that don't fetch texels one by one
+		bool bilinear;
+	};
+
+	const std::vector<QuadMaterial> quadMaterials
+	{
+		{ "VRPost/LogLuminance", "VRPost/LogLuminance_ps", { "hdr" }, true },
+		{ "VRPost/LuminanceReduce", "VRPost/LuminanceReduce_ps", { "source" }, false },
+		{ "VRPost/Adapt", "VRPost/Adapt_ps", { "averageLogLuminance", "adaptedLuminance" }, false },
+		{ "VRPost/Copy", "VRPost/Copy_ps", { "source" }, false },
+		{ "VRPost/BrightPass", "VRPost/BrightPass_ps", { "hdr", "adaptedLuminance" }, true },
+		{ "VRPost/BlurH", "VRPost/Blur_ps", { "source" }, true },
+		{ "VRPost/BlurV", "VRPost/Blur_ps", { "source" }, true },
+		{ "VRPost/ToneMap", "VRPost/ToneMap_ps", { "hdr", "bloom", "adaptedLuminance" }, true },
+	};
+
+	Ogre::String luminanceName(size_t level)
+	{
+		return "luminance" + std::to_string(level);
+	}
+}
+
+constexpr Ogre::PixelFormat StereoPostProcess::hdrFormat;
+constexpr const char* const StereoPostProcess::quadVertexProgramName;
+
+StereoPostProcess::StereoPostProcess() :
+	keyValue{ 0.18f },
+	adaptationSpeed{ 1.5f },
+	bloomThreshold{ 1 },
+	bloomStrength{ 0.3f },
+	lift{ Ogre::Vector3::ZERO },
+	gamma{ Ogre::Vector3::UNIT_SCALE },
+	gain{ Ogre::Vector3::UNIT_SCALE },
+	saturation{ 1 }
+{
+}
+
+void StereoPostProcess::createResources(Ogre::uint32 bufferWidth, Ogre::uint32 bufferHeight)
+{
+	if (!textures.empty()) return;
+
+	auto& textureManager = Ogre::TextureManager::getSingleton();
+	const auto createTarget = [&](const Ogre::String& name, Ogre::uint32 targetWidth, Ogre::uint32 targetHeight, Ogre::PixelFormat format)
+	{
+		auto texture = textureManager.createManual("VRPost/" + name, group, Ogre::TEX_TYPE_2D,
+												   std::max<Ogre::uint32>(1, targetWidth), std::max<Ogre::uint32>(1, targetHeight), 0,
+												   format, Ogre::TU_RENDERTARGET);
+		texture->getBuffer()->getRenderTarget()->setDepthBufferPool(Ogre::DepthBuffer::POOL_NO_DEPTH);
+		textures.push_back(texture);
+		textureNames.push_back(name);
+	};
+
+	//Bloom is blurred back and forth between these two, at half the eye buffer resolution
+	createTarget("bloom0", bufferWidth / 2, bufferHeight / 2, hdrFormat);
+	createTarget("bloom1", bufferWidth / 2, bufferHeight / 2, hdrFormat);
+	for (size_t level{ 0 }; level < luminanceLevels; ++level)
+		createTarget(luminanceName(level), luminanceWidth >> (2 * level), luminanceHeight >> (2 * level), Ogre::PF_FLOAT32_GR);
+	createTarget("adaptedLuminance", 1, 1, Ogre::PF_FLOAT32_R);
+	createTarget("nextAdaptedLuminance", 1, 1, Ogre::PF_FLOAT32_R);
+	if (!sceneFilter.empty())
+		createTarget("filtered", bufferWidth, bufferHeight, hdrFormat);
+
+	createMaterials();
+	updateMaterials();
+}
+
+void StereoPostProcess::createMaterials()
+{
+	auto& programManager = Ogre::HighLevelGpuProgramManager::getSingleton();
+	const auto createProgram = [&](const Ogre::String& name, Ogre::GpuProgramType type, const Ogre::String& source)
+	{
+		auto program = programManager.createProgram(name, group, "glsl", type);
+		program->setSource(source);
+		program->load();
+		return program;
+	};
+
+	auto vertexProgram = createProgram(quadVertexProgramName, Ogre::GPT_VERTEX_PROGRAM, quadVertexProgram);
+	vertexProgram->getDefaultParameters()->setNamedAutoConstant("worldViewProj", Ogre::GpuProgramParameters::ACT_WORLDVIEWPROJ_MATRIX);
+	for (const auto& fragmentProgram : fragmentPrograms)
+		createProgram(fragmentProgram.first, Ogre::GPT_FRAGMENT_PROGRAM, Ogre::String{ fragmentHeader } + fragmentProgram.second);
+
+	//Full screen triangles over targets without depth buffer
+	Ogre::HlmsMacroblock macroblock;
+	macroblock.mDepthCheck = false;
+	macroblock.mDepthWrite = false;
+	macroblock.mCullMode = Ogre::CULL_NONE;
+
+	Ogre::HlmsSamplerblock samplerblock;
+	samplerblock.mMipFilter = Ogre::FO_NONE;
+	samplerblock.mU = samplerblock.mV = samplerblock.mW = Ogre::TAM_CLAMP;
+
+	for (const auto& quadMaterial : quadMaterials)
+	{
+		auto material = Ogre::MaterialManager::getSingleton().create(quadMaterial.name, group);
+		auto pass = material->getTechnique(0)->getPass(0);
+		pass->setMacroblock(macroblock);
+		pass->setVertexProgram(vertexProgram->getName());
+		pass->setFragmentProgram(quadMaterial.fragmentProgram);
+
+		samplerblock.mMinFilter = samplerblock.mMagFilter = quadMaterial.bilinear ? Ogre::FO_LINEAR : Ogre::FO_POINT;
+		for (size_t unit{ 0 }; unit < quadMaterial.samplers.size(); ++unit)
+		{
+			pass->createTextureUnitState()->setSamplerblock(samplerblock);
+			pass->getFragmentProgramParameters()->setNamedConstant(quadMaterial.samplers[unit], int(unit));
+		}
+
+		material->load();
+		materials.push_back(material);
+	}
+}
+
+void StereoPostProcess::updateMaterials() const
+{
+	if (materials.empty()) return;
+
+	const auto parameters = [this](const char* name)
+	{
+		const auto material = std::find_if(materials.begin(), materials.end(), [name](const Ogre::MaterialPtr& material) { return material->getName() == name; });
+		return (*material)->getTechnique(0)->getPass(0)->getFragmentProgramParameters();
+	};
+
+	auto adapt = parameters("VRPost/Adapt");
+	adapt->setNamedAutoConstantReal("frameTime", Ogre::GpuProgramParameters::ACT_FRAME_TIME, 1);
+	adapt->setNamedConstant("adaptationSpeed", adaptationSpeed);
+
+	auto brightPass = parameters("VRPost/BrightPass");
+	brightPass->setNamedConstant("keyValue", keyValue);
+	brightPass->setNamedConstant("bloomThreshold", bloomThreshold);
+
+	parameters("VRPost/BlurH")->setNamedConstant("direction", Ogre::Vector2::UNIT_X);
+	parameters("VRPost/BlurV")->setNamedConstant("direction", Ogre::Vector2::UNIT_Y);
+
+	auto toneMap = parameters("VRPost/ToneMap");
+	toneMap->setNamedConstant("keyValue", keyValue);
+	toneMap->setNamedConstant("bloomStrength", bloomStrength);
+	toneMap->setNamedConstant("lift", lift);
+	toneMap->setNamedConstant("gamma", gamma);
+	toneMap->setNamedConstant("gain", gain);
+	toneMap->setNamedConstant("saturation", saturation);
+}
+
+void StereoPostProcess::createNodeDef(Ogre::CompositorManager2* compositor, Ogre::CompositorWorkspaceDef* workspaceDef, Ogre::IdString sceneNodeName, bool hiddenArea) const
+{
+	if (!compositor->hasNodeDefinition(nodeName))
+	{
+		auto nodeDef = compositor->addNodeDefinition(nodeName);
+		nodeDef->addTextureSourceName("hdr", 0, Ogre::TextureDefinitionBase::TEXTURE_INPUT);
+		nodeDef->addTextureSourceName("output", 1, Ogre::TextureDefinitionBase::TEXTURE_INPUT);
+		for (size_t i{ 0 }; i < textureNames.size(); ++i)
+			nodeDef->addTextureSourceName(textureNames[i], 2 + i, Ogre::TextureDefinitionBase::TEXTURE_INPUT);
+
+		nodeDef->setNumTargetPass(luminanceLevels + (sceneFilter.empty() ? 6 : 7));
+		const auto addQuad = [nodeDef](const Ogre::String& target, const Ogre::String& material, std::initializer_list<Ogre::String> sources, size_t passCount = 1)
+		{
+			auto targetDef = nodeDef->addTargetPass(target);
+			targetDef->setNumPasses(passCount);
+			auto quadDef = static_cast<Ogre::CompositorPassQuadDef*>(targetDef->addPass(Ogre::PASS_QUAD));
+			quadDef->mMaterialName = material;
+			size_t unit{ 0 };
+			for (const auto& source : sources)
+				quadDef->addQuadTextureSource(unit++, source, 0);
+			return targetDef;
+		};
+
+		//Everything else reads the filtered scene
+		const Ogre::String scene{ sceneFilter.empty() ? "hdr" : "filtered" };
+		if (!sceneFilter.empty())
+			addQuad("filtered", sceneFilter, { "hdr" });
+
+		//Exposure, measured once on both eyes. What the lenses don't show is left out, it is only the background
+		auto logLuminanceDef = addQuad(luminanceName(0), "VRPost/LogLuminance", { scene }, hiddenArea ? 2 : 1);
+		if (hiddenArea) HiddenAreaMesh::addPass(logLuminanceDef, true);
+		for (size_t level{ 1 }; level < luminanceLevels; ++level)
+			addQuad(luminanceName(level), "VRPost/LuminanceReduce", { luminanceName(level - 1) });
+		addQuad("nextAdaptedLuminance", "VRPost/Adapt", { luminanceName(luminanceLevels - 1), "adaptedLuminance" });
+		addQuad("adaptedLuminance", "VRPost/Copy", { "nextAdaptedLuminance" });
+
+		//Bloom, at half resolution
+		addQuad("bloom0", "VRPost/BrightPass", { scene, "nextAdaptedLuminance" });
+		addQuad("bloom1", "VRPost/BlurH", { "bloom0" });
+		addQuad("bloom0", "VRPost/BlurV", { "bloom1" });
+
+		addQuad("output", "VRPost/ToneMap", { scene, "bloom0", "nextAdaptedLuminance" });
+	}
+
+	//The scene node renders to the HDR texture, and hands it over
+	workspaceDef->connectExternal(1, sceneNodeName, 0);
+	workspaceDef->connect(sceneNodeName, 0, nodeName, 0);
+	workspaceDef->connectExternal(0, nodeName, 1);
+	for (size_t channel{ 2 }; channel < 2 + textures.size(); ++channel)
+		workspaceDef->connectExternal(channel, nodeName, channel);
+}
+
+void StereoPostProcess::addChannels(Ogre::CompositorChannelVec& channels) const
+{
+	for (const auto& texture : textures)
+	{
+		Ogre::CompositorChannel channel;
+		channel.target = texture->getBuffer()->getRenderTarget();
+		channel.textures.push_back(texture);
+		channels.push_back(channel);
+	}
+}
+
+void StereoPostProcess::setSceneFilter(const Ogre::String& materialName)
+{
+	sceneFilter = materialName;
+}
+
+void StereoPostProcess::setExposure(float key, float speed)
+{
+	keyValue = key;
+	adaptationSpeed = speed;
+	updateMaterials();
+}
+
+void StereoPostProcess::setBloom(float threshold, float strength)
+{
+	bloomThreshold = threshold;
+	bloomStrength = strength;
+	updateMaterials();
+}
+
+void StereoPostProcess::setGrading(const Ogre::Vector3& gradingLift, const Ogre::Vector3& gradingGamma, const Ogre::Vector3& gradingGain, float gradingSaturation)
+{
+	lift = gradingLift;
+	gamma = gradingGamma;
+	gain = gradingGain;
+	saturation = gradingSaturation;
+	updateMaterials();
+}
+
+size_t StereoPostProcess::getTextureBytes() const
+{
+	size_t bytes{ 0 };
+	for (const auto& texture : textures)
+		bytes += texture->getSize();
+	return bytes;
+}
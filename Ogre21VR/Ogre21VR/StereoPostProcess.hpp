@@ -0,0 +1,72 @@
+#pragma once
+
+//C++ standard libraries
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/Compositor/OgreCompositorChannel.h>
+#include <OGRE/Compositor/OgreCompositorManager2.h>
+#include <OGRE/Compositor/OgreCompositorNodeDef.h>
+#include <OGRE/Compositor/OgreCompositorWorkspaceDef.h>
+
+///HDR look of the eye buffers : tone mapping with eye adaptation, bloom and color grading.
+///Every pass runs once over the side by side eye buffer, never once per eye. The exposure is measured on both eyes at once,
+///so they always agree on it. The intermediate textures are created once and shared by the workspaces of all the eye buffers
+class StereoPostProcess
+{
+public:
+	///Name of the node definition that reads the HDR scene and writes the eye buffer
+	static constexpr const char* const nodeName{ "VRPostProcessNode" };
+	///Format the eyes are rendered in before post processing
+	static constexpr Ogre::PixelFormat hdrFormat{ Ogre::PF_FLOAT16_RGBA };
+	///Vertex program of the full screen passes, for the materials of passes added to the chain
+	static constexpr const char* const quadVertexProgramName{ "VRPost/Quad_vs" };
+
+	StereoPostProcess();
+
+	///Create the intermediate textures for eye buffers of that size, and the materials. Done by the renderer with the eye buffers
+	void createResources(Ogre::uint32 bufferWidth, Ogre::uint32 bufferHeight);
+	///Create the node definition, if it doesn't exist yet, and connect it after "sceneNodeName" in the workspace definition.
+	///External channel 0 is the eye buffer, 1 the HDR scene the other node renders to, then the channels of addChannels.
+	///With "hiddenArea", the hidden area mesh pass masks the exposure measure : its pass provider has to be set already
+	void createNodeDef(Ogre::CompositorManager2* compositor, Ogre::CompositorWorkspaceDef* workspaceDef, Ogre::IdString sceneNodeName, bool hiddenArea = false) const;
+	///Add the shared intermediate textures to the external channels of an eye buffer workspace, after the eye buffer and the HDR scene
+	void addChannels(Ogre::CompositorChannelVec& channels) const;
+	///Filter the HDR scene with that material before everything else, into a shared full resolution texture. Sampler 0 is the scene.
+	///Call this before the resources are created
+	void setSceneFilter(const Ogre::String& materialName);
+
+	///Average scene luminance is exposed to "keyValue". The exposure follows the scene at "adaptationSpeed" (1/s)
+	void setExposure(float keyValue, float adaptationSpeed);
+	///Exposed colors above "threshold" bleed into their surroundings, added back with "strength"
+	void setBloom(float threshold, float strength);
+	///Lift, gamma and gain per channel then saturation, applied to the tone mapped colors
+	void setGrading(const Ogre::Vector3& lift, const Ogre::Vector3& gamma, const Ogre::Vector3& gain, float saturation);
+
+	///GPU memory of the shared intermediate textures
+	size_t getTextureBytes() const;
+
+private:
+	///Create the GLSL programs and the materials of the quad passes
+	void createMaterials();
+	///Give the current settings to the materials
+	void updateMaterials() const;
+
+	///Luminance is reduced by 4 in each direction, from this size down to 1x1. Red is the average log luminance, green the share of it that counts
+	static constexpr Ogre::uint32 luminanceWidth{ 256 }, luminanceHeight{ 128 };
+	static constexpr size_t luminanceLevels{ 5 };
+
+	float keyValue, adaptationSpeed;
+	float bloomThreshold, bloomStrength;
+	Ogre::Vector3 lift, gamma, gain;
+	float saturation;
+
+	///Material of the pass filtering the scene first. Empty for none
+	Ogre::String sceneFilter;
+
+	///bloom0, bloom1, the luminance levels, the adapted luminance and its next value, then the filtered scene. In the order of the node inputs
+	std::vector<Ogre::TexturePtr> textures;
+	std::vector<Ogre::String> textureNames;
+	std::vector<Ogre::MaterialPtr> materials;
+};
@@ -0,0 +1,435 @@
+#include "TextureStreamer.hpp"
+
+#include "FrameArena.hpp"
+
+TextureStreamer::TextureStreamer(size_t workerCount, size_t uploadBudget) :
+	stopping{ false },
+	uploadBudget{ uploadBudget },
+	stagingBuffer{ 0 },
+	residentBytes{ 0 },
+	cpuBytes{ 0 }
+{
+	glGenBuffers(1, &stagingBuffer);
+
+	for (size_t i{ 0 }; i < std::max<size_t>(1, workerCount); ++i)
+		workers.emplace_back(&TextureStreamer::decodeLoop, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stopping = true;
+	}
+	queueCondition.notify_all();
+	for (auto& worker : workers) worker.join();
+
+	glDeleteBuffers(1, &stagingBuffer);
+}
+
+void TextureStreamer::load(const Ogre::String& name, const Ogre::String& group, ReadyCallback onReady)
+{
+	auto streamed = std::make_unique<StreamedTexture>();
+	streamed->name = name;
+	streamed->group = group;
+	streamed->onReady = onReady;
+	streamed->failed = false;
+	streamed->glid = 0;
+	streamed->width = streamed->height = 0;
+	streamed->mipCount = 0;
+	streamed->decoding = false;
+	streamed->residentLevel = 0;
+	streamed->storageLevel = 0;
+	streamed->uploadedRows = 0;
+	streamed->wantedLevel = 0;
+	streamed->node = nullptr;
+	streamed->radius = 0;
+
+	const auto dot = name.find_last_of('.');
+	if (dot != Ogre::String::npos) streamed->extension = name.substr(dot + 1);
+
+	//The mipmap count is only known once decoded, the whole chain is requested
+	requestDecode(*streamed, 0, std::numeric_limits<Ogre::uint8>::max());
+	textures.push_back(std::move(streamed));
+}
+
+void TextureStreamer::setUsage(const Ogre::String& name, Ogre::SceneNode* node, Ogre::Real radius)
+{
+	for (auto& streamed : textures)
+		if (streamed->name == name)
+		{
+			streamed->node = node;
+			streamed->radius = radius;
+		}
+}
+
+void TextureStreamer::setUploadBudget(size_t bytes)
+{
+	uploadBudget = bytes;
+}
+
+size_t TextureStreamer::getResidentBytes() const
+{
+	return residentBytes;
+}
+
+size_t TextureStreamer::getCpuBytes() const
+{
+	return cpuBytes;
+}
+
+void TextureStreamer::requestDecode(StreamedTexture& streamed, Ogre::uint8 firstLevel, Ogre::uint8 endLevel)
+{
+	//Opening the file touches the resource group indexes, that are not thread safe. Reading and decoding it is done by the workers
+	streamed.stream = Ogre::ResourceGroupManager::getSingleton().openResource(streamed.name, streamed.group);
+	streamed.decodeFirst = firstLevel;
+	streamed.decodeEnd = endLevel;
+	streamed.decoding = true;
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		toDecode.push_back(&streamed);
+	}
+	queueCondition.notify_one();
+}
+
+void TextureStreamer::decodeLoop()
+{
+	for (;;)
+	{
+		StreamedTexture* streamed;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, [this] {return stopping || !toDecode.empty(); });
+			if (stopping) return;
+			streamed = toDecode.front();
+			toDecode.pop_front();
+		}
+
+		decode(*streamed);
+
+		std::lock_guard<std::mutex> lock(queueMutex);
+		decoded.push_back(streamed);
+	}
+}
+
+void TextureStreamer::decode(StreamedTexture& streamed)
+{
+	try
+	{
+		Ogre::Image image;
+		image.load(streamed.stream, streamed.extension);
+		streamed.stream.setNull();
+
+		//Block compressed images cannot be rescaled here, they go through the regular TextureManager path
+		if (Ogre::PixelUtil::isCompressed(image.getFormat()))
+		{
+			streamed.failed = true;
+			return;
+		}
+
+		//First decode of the file
+		if (!streamed.mipCount)
+		{
+			streamed.width = image.getWidth();
+			streamed.height = image.getHeight();
+			streamed.mipCount = Ogre::uint8(1 + Ogre::Math::Floor(Ogre::Math::Log2(Ogre::Real(std::max(streamed.width, streamed.height)))));
+			streamed.residentLevel = streamed.storageLevel = streamed.mipCount;
+			streamed.decodeEnd = streamed.mipCount;
+			streamed.levels.resize(streamed.mipCount);
+		}
+
+		//Each level is scaled down from the previous one, only the requested ones are kept
+		std::vector<Ogre::uint8> previous, current;
+		for (Ogre::uint8 level{ 0 }; level < streamed.decodeEnd; ++level)
+		{
+			const auto width = Ogre::uint32(levelWidth(streamed, level));
+			const auto height = Ogre::uint32(levelHeight(streamed, level));
+			current.resize(width * height * bytesPerPixel);
+
+			const Ogre::PixelBox levelBox{ width, height, 1, Ogre::PF_BYTE_RGBA, current.data() };
+			if (level == 0)
+				Ogre::PixelUtil::bulkPixelConversion(image.getPixelBox(), levelBox);
+			else
+				Ogre::Image::scale(Ogre::PixelBox{ Ogre::uint32(levelWidth(streamed, level - 1)), Ogre::uint32(levelHeight(streamed, level - 1)),
+												   1, Ogre::PF_BYTE_RGBA, previous.data() },
+								   levelBox, Ogre::Image::FILTER_BILINEAR);
+
+			if (level >= streamed.decodeFirst) streamed.levels[level] = current;
+			std::swap(previous, current);
+		}
+	}
+	catch (const std::exception&)
+	{
+		streamed.failed = true;
+	}
+}
+
+GLsizei TextureStreamer::levelWidth(const StreamedTexture& streamed, size_t level)
+{
+	return GLsizei(std::max<size_t>(1, streamed.width >> level));
+}
+
+GLsizei TextureStreamer::levelHeight(const StreamedTexture& streamed, size_t level)
+{
+	return GLsizei(std::max<size_t>(1, streamed.height >> level));
+}
+
+size_t TextureStreamer::storageBytes(const StreamedTexture& streamed)
+{
+	size_t bytes{ 0 };
+	for (size_t level{ streamed.storageLevel }; level < streamed.mipCount; ++level)
+		bytes += size_t(levelWidth(streamed, level)) * size_t(levelHeight(streamed, level)) * bytesPerPixel;
+	return bytes;
+}
+
+void TextureStreamer::freeLevel(StreamedTexture& streamed, size_t level)
+{
+	cpuBytes -= streamed.levels[level].size();
+	std::vector<Ogre::uint8>().swap(streamed.levels[level]);
+}
+
+void TextureStreamer::createTexture(StreamedTexture& streamed)
+{
+	for (const auto& level : streamed.levels)
+		cpuBytes += level.size();
+
+	//The smallest levels weight nothing, they are on the GPU from the start so the texture can be sampled at once
+	size_t firstLevel{ streamed.mipCount - 1u };
+	while (firstLevel > 0 && size_t(std::max(levelWidth(streamed, firstLevel - 1), levelHeight(streamed, firstLevel - 1))) <= initialLevelSize)
+		--firstLevel;
+
+	//The PBS HLMS samples everything as texture arrays. The storage starts with the initial levels only
+	streamed.texture = Ogre::TextureManager::getSingleton().
+		createManual(streamed.name, streamed.group, Ogre::TEX_TYPE_2D_ARRAY,
+					 Ogre::uint(levelWidth(streamed, firstLevel)), Ogre::uint(levelHeight(streamed, firstLevel)), 1,
+					 int(streamed.mipCount - firstLevel - 1), Ogre::PF_BYTE_RGBA, Ogre::TU_STATIC_WRITE_ONLY);
+	streamed.texture->getCustomAttribute("GLID", &streamed.glid);
+	streamed.storageLevel = Ogre::uint8(firstLevel);
+	residentBytes += storageBytes(streamed);
+
+	GLint previousTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, streamed.glid);
+	for (auto level = firstLevel; level < streamed.mipCount; ++level)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, GLint(level - firstLevel), 0, 0, 0, levelWidth(streamed, level), levelHeight(streamed, level), 1,
+						GL_RGBA, GL_UNSIGNED_BYTE, streamed.levels[level].data());
+		freeLevel(streamed, level);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, previousTexture);
+	streamed.residentLevel = Ogre::uint8(firstLevel);
+
+	setBaseLevel(streamed);
+	if (streamed.onReady) streamed.onReady(streamed.texture);
+}
+
+void TextureStreamer::resizeStorage(StreamedTexture& streamed, size_t finestLevel)
+{
+	//Resident levels still wanted. A level that was only partially uploaded is dropped
+	const auto keptLevel = std::max<size_t>(streamed.residentLevel, finestLevel);
+
+	GLint previousTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previousTexture);
+
+	//Ogre owns the GL name of the texture, and the datablocks use the Ogre texture : it is recreated in place.
+	//The kept levels wait in a temporary texture meanwhile, they never go through the CPU
+	GLuint kept;
+	glGenTextures(1, &kept);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, kept);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, GLsizei(streamed.mipCount - keptLevel), GL_RGBA8, levelWidth(streamed, keptLevel), levelHeight(streamed, keptLevel), 1);
+	for (auto level = keptLevel; level < streamed.mipCount; ++level)
+		glCopyImageSubData(streamed.glid, GL_TEXTURE_2D_ARRAY, GLint(level - streamed.storageLevel), 0, 0, 0,
+						   kept, GL_TEXTURE_2D_ARRAY, GLint(level - keptLevel), 0, 0, 0,
+						   levelWidth(streamed, level), levelHeight(streamed, level), 1);
+
+	residentBytes -= storageBytes(streamed);
+	streamed.texture->freeInternalResources();
+	streamed.texture->setWidth(Ogre::uint32(levelWidth(streamed, finestLevel)));
+	streamed.texture->setHeight(Ogre::uint32(levelHeight(streamed, finestLevel)));
+	streamed.texture->setNumMipmaps(Ogre::uint8(streamed.mipCount - finestLevel - 1));
+	streamed.texture->createInternalResources();
+	streamed.texture->getCustomAttribute("GLID", &streamed.glid);
+	streamed.storageLevel = Ogre::uint8(finestLevel);
+	streamed.residentLevel = Ogre::uint8(keptLevel);
+	streamed.uploadedRows = 0;
+	residentBytes += storageBytes(streamed);
+
+	for (auto level = keptLevel; level < streamed.mipCount; ++level)
+		glCopyImageSubData(kept, GL_TEXTURE_2D_ARRAY, GLint(level - keptLevel), 0, 0, 0,
+						   streamed.glid, GL_TEXTURE_2D_ARRAY, GLint(level - finestLevel), 0, 0, 0,
+						   levelWidth(streamed, level), levelHeight(streamed, level), 1);
+	glDeleteTextures(1, &kept);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, previousTexture);
+	setBaseLevel(streamed);
+}
+
+void TextureStreamer::setBaseLevel(StreamedTexture& streamed)
+{
+	GLint previousTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, streamed.glid);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, streamed.residentLevel - streamed.storageLevel);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, previousTexture);
+}
+
+size_t TextureStreamer::stage(StreamedTexture& streamed, size_t budget, Ogre::uint8* staging, size_t stagingOffset)
+{
+	//The storage is grown before the staging buffer is mapped, and the level may still be decoding
+	const size_t level{ streamed.residentLevel - 1u };
+	if (level < streamed.storageLevel || streamed.levels[level].empty()) return 0;
+
+	const auto levelRows = size_t(levelHeight(streamed, level));
+	const auto rowBytes = size_t(levelWidth(streamed, level)) * bytesPerPixel;
+
+	const auto rows = std::min(levelRows - streamed.uploadedRows, budget / rowBytes);
+	if (rows == 0) return 0;
+
+	const auto bytes = rows * rowBytes;
+	memcpy(staging + stagingOffset, streamed.levels[level].data() + streamed.uploadedRows * rowBytes, bytes);
+
+	PendingUpload pending;
+	pending.streamed = &streamed;
+	pending.level = Ogre::uint8(level);
+	pending.firstRow = streamed.uploadedRows;
+	pending.rows = rows;
+	pending.stagingOffset = stagingOffset;
+	pending.completesLevel = streamed.uploadedRows + rows == levelRows;
+	pendingUploads.push_back(pending);
+
+	streamed.uploadedRows += rows;
+	if (pending.completesLevel)
+	{
+		//The staging buffer has its own copy now
+		streamed.uploadedRows = 0;
+		streamed.residentLevel = Ogre::uint8(level);
+		freeLevel(streamed, level);
+	}
+
+	return bytes;
+}
+
+void TextureStreamer::update(const Ogre::Vector3& viewPoint, Ogre::Real pixelsPerTangent)
+{
+	//Copied out of the queue instead of swapping it, so a frame without new textures doesn't allocate
+	ScratchScope scratch;
+	auto ready = scratch.makeVector<StreamedTexture*>();
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		ready.assign(decoded.begin(), decoded.end());
+		decoded.clear();
+	}
+
+	for (auto streamed : ready)
+	{
+		streamed->decoding = false;
+
+		//Levels decoded again after an eviction
+		if (!streamed->texture.isNull())
+		{
+			for (size_t level{ streamed->decodeFirst }; level < streamed->decodeEnd; ++level)
+				cpuBytes += streamed->levels[level].size();
+			if (streamed->failed)
+				Ogre::LogManager::getSingleton().logMessage("TextureStreamer : cannot decode " + streamed->name + " again, keeping its resident mipmaps");
+			continue;
+		}
+
+		if (!streamed->failed)
+		{
+			createTexture(*streamed);
+			continue;
+		}
+
+		Ogre::LogManager::getSingleton().logMessage("TextureStreamer : cannot stream " + streamed->name + ", loading it synchronously");
+		streamed->texture = Ogre::TextureManager::getSingleton().load(streamed->name, streamed->group, Ogre::TEX_TYPE_2D_ARRAY);
+		if (streamed->onReady) streamed->onReady(streamed->texture);
+	}
+
+	//Decide which levels each texture needs from its size in the eye buffers
+	for (auto& streamed : textures)
+	{
+		if (!streamed->glid || !streamed->node || streamed->decoding) continue;
+
+		const auto distance = std::max(streamed->radius, (streamed->node->_getDerivedPosition() - viewPoint).length());
+		const auto footprint = std::max(Ogre::Real(1), 2 * streamed->radius / distance * pixelsPerTangent);
+		const auto level = Ogre::Math::Floor(Ogre::Math::Log2(Ogre::Real(std::max(streamed->width, streamed->height)) / footprint));
+		streamed->wantedLevel = Ogre::uint8(Ogre::Math::Clamp<Ogre::Real>(level, 0, Ogre::Real(streamed->mipCount - 1)));
+
+		//Give back the memory of the levels that are not needed anymore. One level of slack to not thrash at the boundary
+		if (streamed->wantedLevel > streamed->residentLevel + 1)
+			resizeStorage(*streamed, streamed->wantedLevel);
+		for (size_t unneeded{ 0 }; unneeded + 1 < streamed->wantedLevel; ++unneeded)
+			freeLevel(*streamed, unneeded);
+	}
+
+	//The next level to upload is not on the CPU anymore : read the file again, for all the levels needed
+	for (auto& streamed : textures)
+	{
+		if (!streamed->glid || streamed->decoding || streamed->failed || streamed->residentLevel <= streamed->wantedLevel) continue;
+		if (!streamed->levels[streamed->residentLevel - 1].empty()) continue;
+
+		try
+		{
+			requestDecode(*streamed, streamed->wantedLevel, streamed->residentLevel);
+		}
+		catch (const Ogre::Exception& e)
+		{
+			streamed->failed = true;
+			Ogre::LogManager::getSingleton().logMessage("TextureStreamer : cannot open " + streamed->name + " again : " + e.getDescription());
+		}
+	}
+
+	//Send the next levels through the staging buffer, within the budget
+	if (uploadBudget == 0) return;
+	const auto canUpload = [](const StreamedTexture& streamed)
+	{
+		return streamed.glid && !streamed.decoding && streamed.residentLevel > streamed.wantedLevel && !streamed.levels[streamed.residentLevel - 1].empty();
+	};
+
+	//Room for the next level. Recreating the texture must not happen while a pixel unpack buffer is bound
+	bool needsUpload{ false };
+	for (auto& streamed : textures)
+		if (canUpload(*streamed))
+		{
+			if (streamed->storageLevel == streamed->residentLevel) resizeStorage(*streamed, streamed->residentLevel - 1u);
+			needsUpload = true;
+		}
+	if (!needsUpload) return;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+	//Orphan the previous frame's staging memory instead of waiting for the GPU to be done with it
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, uploadBudget, nullptr, GL_STREAM_DRAW);
+	auto staging = static_cast<Ogre::uint8*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, uploadBudget,
+															  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	size_t used{ 0 };
+	pendingUploads.clear();
+	for (auto& streamed : textures)
+		while (canUpload(*streamed))
+		{
+			const auto bytes = stage(*streamed, uploadBudget - used, staging, used);
+			if (bytes == 0) break;
+			used += bytes;
+		}
+
+	//A buffer cannot be read by GL while it's mapped : copy everything first, then upload from it
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	GLint previousTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previousTexture);
+	for (const auto& pending : pendingUploads)
+	{
+		const auto& streamed = *pending.streamed;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, streamed.glid);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, pending.level - streamed.storageLevel, 0, GLint(pending.firstRow), 0,
+						levelWidth(streamed, pending.level), GLsizei(pending.rows), 1,
+						GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(pending.stagingOffset));
+
+		//The whole level is there, it can be sampled
+		if (pending.completesLevel)
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, streamed.residentLevel - streamed.storageLevel);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, previousTexture);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <Windows.h>
+
+//OpenGL extension loading
+#include <GL/gl3w.h>
+
+//C++ standard libraries
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreImage.h>
+#include <OGRE/OgreSceneNode.h>
+
+///Load textures on worker threads and upload them to the GPU a few mipmaps at a time, coarsest first.
+///The GPU storage of a texture only holds the levels in use : it shrinks when levels are evicted, and grows one level at a time
+class TextureStreamer
+{
+public:
+	///Called on the render thread once the lowest mipmaps of a texture are on the GPU
+	using ReadyCallback = std::function<void(Ogre::TexturePtr)>;
+
+	///Construct a streamer decoding images on "workerCount" threads, and uploading at most "uploadBudget" bytes per frame
+	TextureStreamer(size_t workerCount, size_t uploadBudget);
+	///Stop the workers
+	~TextureStreamer();
+
+	///Start streaming a texture file. "onReady" gets a 2D array texture usable by the HLMS
+	void load(const Ogre::String& name, const Ogre::String& group, ReadyCallback onReady);
+	///Use the projected size of "node" (a sphere of "radius" around it) to decide how many mipmaps the texture needs
+	void setUsage(const Ogre::String& name, Ogre::SceneNode* node, Ogre::Real radius);
+	///Set how many bytes can be sent to the GPU each frame
+	void setUploadBudget(size_t bytes);
+
+	///Finish loads, evict and upload mipmaps. "pixelsPerTangent" is the eye buffer resolution for a tangent of 1. Render thread only
+	void update(const Ogre::Vector3& viewPoint, Ogre::Real pixelsPerTangent);
+
+	///GPU storage of the streamed textures, in bytes
+	size_t getResidentBytes() const;
+	///CPU copies of the mipmaps waiting to be uploaded, in bytes. Evicted levels are decoded again from the file when needed
+	size_t getCpuBytes() const;
+
+private:
+	struct StreamedTexture
+	{
+		Ogre::String name, group;
+		ReadyCallback onReady;
+		Ogre::DataStreamPtr stream;
+		Ogre::String extension;
+		bool failed;
+
+		Ogre::TexturePtr texture;
+		GLuint glid;
+		size_t width, height;
+		Ogre::uint8 mipCount;
+		///CPU copy of the mipmap levels not uploaded yet, converted to RGBA8. Empty for the others
+		std::vector<std::vector<Ogre::uint8>> levels;
+		///Levels the workers have to decode, from "decodeFirst" to "decodeEnd" excluded. The levels are off limits while "decoding"
+		Ogre::uint8 decodeFirst, decodeEnd;
+		bool decoding;
+		///Finest level completely on the GPU (mipCount when nothing is)
+		Ogre::uint8 residentLevel;
+		///Finest level the GPU storage has room for. Level 0 of the GL texture. One finer than "residentLevel" while it's uploaded
+		Ogre::uint8 storageLevel;
+		///Rows of the level "residentLevel - 1" already uploaded
+		size_t uploadedRows;
+		///Finest level worth uploading according to the screen footprint
+		Ogre::uint8 wantedLevel;
+
+		Ogre::SceneNode* node;
+		Ogre::Real radius;
+	};
+
+	///A range of rows copied to the staging buffer, to be sent to the texture once the buffer is unmapped
+	struct PendingUpload
+	{
+		StreamedTexture* streamed;
+		Ogre::uint8 level;
+		size_t firstRow, rows;
+		size_t stagingOffset;
+		bool completesLevel;
+	};
+
+	///Open the file and queue it for the workers, to decode the levels from "firstLevel" to "endLevel" excluded. Render thread
+	void requestDecode(StreamedTexture& streamed, Ogre::uint8 firstLevel, Ogre::uint8 endLevel);
+	///Worker thread main loop
+	void decodeLoop();
+	///Decode the image and build the requested levels of its mipmap chain. Worker thread
+	static void decode(StreamedTexture& streamed);
+	///Create the GPU texture and send the smallest mipmaps right away
+	void createTexture(StreamedTexture& streamed);
+	///Reallocate the GPU storage to hold the levels from "finestLevel" on, keeping the resident ones among them
+	void resizeStorage(StreamedTexture& streamed, size_t finestLevel);
+	///Drop the CPU copy of a level
+	void freeLevel(StreamedTexture& streamed, size_t level);
+	///Copy up to "budget" bytes of the next level of this texture to the staging buffer. Return the bytes used
+	size_t stage(StreamedTexture& streamed, size_t budget, Ogre::uint8* staging, size_t stagingOffset);
+	///Only sample the levels that are on the GPU
+	static void setBaseLevel(StreamedTexture& streamed);
+
+	static GLsizei levelWidth(const StreamedTexture& streamed, size_t level);
+	static GLsizei levelHeight(const StreamedTexture& streamed, size_t level);
+	///Bytes of the GPU storage of a texture, all its levels included
+	static size_t storageBytes(const StreamedTexture& streamed);
+
+	std::vector<std::unique_ptr<StreamedTexture>> textures;
+	std::vector<PendingUpload> pendingUploads;
+	std::vector<std::thread> workers;
+	std::deque<StreamedTexture*> toDecode, decoded;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	bool stopping;
+
+	size_t uploadBudget;
+	GLuint stagingBuffer;
+	size_t residentBytes;
+	size_t cpuBytes;
+
+	///Levels at or below this size are uploaded as soon as the image is decoded
+	static constexpr size_t initialLevelSize{ 64 };
+	static constexpr size_t bytesPerPixel{ 4 };
+};
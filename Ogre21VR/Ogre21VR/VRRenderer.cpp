@@ -5,8 +5,51 @@ auto logToOgre = [](const std::string& message)
 	Ogre::LogManager::getSingleton().logMessage(message);
 };
 
+//Size of the vertex and index buffers of a V2 mesh. The LODs and the shadow pass share some of them, they are counted once
+auto meshBufferBytes = [](const Ogre::MeshPtr& mesh)
+{
+	std::set<const Ogre::BufferPacked*> buffers;
+	for (auto subMesh : mesh->getSubMeshes())
+		for (auto pass : { Ogre::VpNormal, Ogre::VpShadow })
+			for (auto vao : subMesh->mVao[pass])
+			{
+				buffers.insert(vao->getVertexBuffers().begin(), vao->getVertexBuffers().end());
+				if (vao->getIndexBuffer()) buffers.insert(vao->getIndexBuffer());
+			}
+
+	size_t bytes{ 0 };
+	for (auto buffer : buffers)
+		bytes += buffer->getNumElements() * buffer->getBytesPerElement();
+	return bytes;
+};
+
+//Size of a texture with all its mipmaps
+auto textureBytes = [](const Ogre::TexturePtr& texture)
+{
+	size_t bytes{ 0 };
+	for (size_t level{ 0 }; level <= texture->getNumMipmaps(); ++level)
+	{
+		//The slices of an array don't shrink with the mipmaps, the depth of a volume does
+		const auto width = std::max<Ogre::uint32>(1, texture->getWidth() >> level);
+		const auto height = std::max<Ogre::uint32>(1, texture->getHeight() >> level);
+		const auto depth = texture->getTextureType() == Ogre::TEX_TYPE_3D ? std::max<Ogre::uint32>(1, texture->getDepth() >> level) : texture->getDepth();
+		bytes += Ogre::PixelUtil::getMemorySize(width, height, depth, texture->getFormat());
+	}
+	return bytes * texture->getNumFaces();
+};
+
 VRRenderer::~VRRenderer()
 {
+	for (auto& eyeBuffer : eyeBuffers)
+	{
+		if (eyeBuffer.fence) glDeleteSync(eyeBuffer.fence);
+		glDeleteQueries(1, &eyeBuffer.timerQuery);
+	}
+
+	//The streamer and the light grid own GL objects, they have to go while the context is alive
+	textureStreamer.reset();
+	stereoLightGrid.reset();
+	hiddenAreaMesh.reset();
 	glfwTerminate();
 }
 
@@ -18,17 +61,97 @@ VRRenderer::VRRenderer(int openGLMajor, int openGLMinor) :
 	windowName{ "Window" },
 	glMajor{ openGLMajor },
 	glMinor{ openGLMinor },
+	accumulatedFrameMs{ 0 },
+	accumulatedFenceWaitMs{ 0 },
+	accumulatedGpuMs{ 0 },
+	accumulatedFrames{ 0 },
+	eyeBufferReport{},
+	startTime{ std::chrono::steady_clock::now() },
+	timeToFirstFrame{ 0 },
+	firstFrameSubmitted{ false },
 	monoscopicCompositor{ "MonoscopicWorspace" },
 	stereoscopicCompositor{ "StereoscopicWorkspace" },
+	overlayCompositor{ "OverlayLayerWorkspace" },
 	running{ false },
 	smgr{ nullptr },
 	backgroundColor{ 0.2f, 0.4f, 0.6f },
 	AALevel{ 4 },
 	nearClippingDistance{ 0.1 },
-	farClippingDistance{ 1000 }
+	farClippingDistance{ 1000 },
+	depthSubmission{ false },
+	reverseDepth{ false },
+	datablocksChanged{ true },
+	framesInFlight{ 2 },
+	currentEyeBuffer{ 0 },
+	eyeBufferStats{},
+	trackingFrame{ 0 },
+	trackedDeviceNodes{},
+	trackedDevicePoses{},
+	trackedDeviceValid{},
+	controllerButtons{},
+	hiddenArea{ false },
+	hiddenAreaRadius{ 1 },
+	eyeFov{ { { 1, 1, 1, 1 }, { 1, 1, 1, 1 } } },
+	frameArena{ frameArenaSize },
+	meshLodLevels{ 3 },
+	meshLodKeepPerLevel{ 0.5f },
+	meshLodMaxPixelError{ 1 },
+	indexOptimisation{ true },
+	indexOptimisationOverdraw{ true },
+	indexOptimisationCacheSize{ 16 },
+	vertexCompression{ false, false, false, false },
+	pixelsPerTangent{ 1024 }
 {
+	eyeBufferReport.reserve(eyeBufferReportSize);
 	initOgre();
 	loadOpenGLFunctions();
+	addMemorySources();
+}
+
+void VRRenderer::addMemorySources()
+{
+	//Render targets are accounted as eye targets or overlays where they are created
+	memoryTracker.addGpuSource(GpuMemory::Textures, "Texture manager", []
+	{
+		size_t bytes{ 0 };
+		auto textures = Ogre::TextureManager::getSingleton().getResourceIterator();
+		while (textures.hasMoreElements())
+		{
+			const auto texture = textures.getNext().staticCast<Ogre::Texture>();
+			if (!(texture->getUsage() & Ogre::TU_RENDERTARGET))
+				bytes += textureBytes(texture);
+		}
+		return bytes;
+	});
+	memoryTracker.addGpuSource(GpuMemory::ShadowMaps, "Cascades", [this]
+	{
+		return shadowCache ? shadowCache->getShadowMapBytes() * eyeBuffers.size() : 0;
+	});
+	memoryTracker.addGpuSource(GpuMemory::EyeTargets, "Post processing intermediates", [this]
+	{
+		return postProcess ? postProcess->getTextureBytes() : 0;
+	});
+	memoryTracker.addGpuSource(GpuMemory::ConstantBuffers, "Stereo light grid", [this]
+	{
+		return stereoLightGrid ? stereoLightGrid->getUploadBytes() : 0;
+	});
+
+	memoryTracker.addCpuSource("Meshes", "V1 mesh manager", []
+	{
+		return Ogre::v1::MeshManager::getSingleton().getMemoryUsage();
+	});
+	memoryTracker.addCpuSource("Textures", "Texture streamer", [this]
+	{
+		return textureStreamer ? textureStreamer->getCpuBytes() : 0;
+	});
+	memoryTracker.addCpuSource("Frame arenas", "Frame", [this]
+	{
+		return frameArena.getCapacity();
+	});
+	memoryTracker.addCpuSource("Frame arenas", "Scratch", []
+	{
+		return ScratchScope::getTotalCapacity();
+	});
 }
 
 void VRRenderer::loadOpenGLFunctions()
@@ -89,11 +212,13 @@ void VRRenderer::initOgre()
 
 	//Create the window, the scene and the cameras
 	window = root->createRenderWindow(windowName, width, height, false, &windowParameters);
+	//The worker threads of the scene manager also build the stereo light grid
 	smgr = root->createSceneManager(Ogre::ST_GENERIC, threads, Ogre::INSTANCING_CULLING_THREADED);
 	cameraRig = smgr->getRootSceneNode()->createChildSceneNode();
 	attachCameraToRig(stereoCameras[0] = smgr->createCamera("LeftEyeVR"));
 	attachCameraToRig(stereoCameras[1] = smgr->createCamera("RightEyeVR"));
 	attachCameraToRig(monoCamera = smgr->createCamera("MonoCamera"));
+	attachCameraToRig(lodCamera = smgr->createCamera("LodCameraVR"));
 
 	//Do some minor camera configuration :
 	monoCamera->setNearClipDistance(nearClippingDistance);
@@ -107,8 +232,8 @@ void VRRenderer::initOgre()
 	//Setup the rendering pipeline by creating a basic compositor workspace
 	auto compositor = root->getCompositorManager2();
 	if (!compositor->hasWorkspaceDefinition(monoscopicCompositor))
-		compositor->createBasicWorkspaceDef(monoscopicCompositor, backgroundColor);
-	compositorWorkspaces[0] = compositor->addWorkspace(smgr, window, monoCamera, monoscopicCompositor, false, 0, Ogre::Vector4(0, 0, 1, 1), 0x03, 0x03);
+		createWorkspaceDef(monoscopicCompositor, "MonoscopicNode", backgroundColor);
+	monoscopicWorkspace = compositor->addWorkspace(smgr, window, monoCamera, monoscopicCompositor, false, 0, Ogre::Vector4(0, 0, 1, 1), 0x03, 0x03);
 
 	//everything is right :
 	running = true;
@@ -119,6 +244,7 @@ void VRRenderer::setNearClippingDistance(double d)
 	nearClippingDistance = d;
 	setCorrectProjectionMatrix();
 	monoCamera->setNearClipDistance(nearClippingDistance);
+	updateCameraProjection(monoCamera, Ogre::Real(width) / Ogre::Real(height));
 }
 
 void VRRenderer::setFarClippingDistance(double d)
@@ -126,6 +252,926 @@ void VRRenderer::setFarClippingDistance(double d)
 	farClippingDistance = d;
 	setCorrectProjectionMatrix();
 	monoCamera->setFarClipDistance(farClippingDistance);
+	reverseDepthFarClips.erase(monoCamera);
+	updateCameraProjection(monoCamera, Ogre::Real(width) / Ogre::Real(height));
+}
+
+void VRRenderer::setDepthSubmission(bool enabled)
+{
+	depthSubmission = enabled;
+}
+
+size_t VRRenderer::createQuadLayer(Ogre::Camera* camera, size_t pixelWidth, size_t pixelHeight, Ogre::Vector2 size,
+								   Ogre::Vector3 position, Ogre::Quaternion orientation, bool headLocked)
+{
+	VROverlayLayer overlay{};
+	overlay.shape = VROverlayLayer::Shape::Quad;
+	overlay.width = pixelWidth;
+	overlay.height = pixelHeight;
+	overlay.size = size;
+	overlay.position = position;
+	overlay.orientation = orientation;
+	overlay.headLocked = headLocked;
+	return addOverlayLayer(std::move(overlay), camera);
+}
+
+size_t VRRenderer::createCylinderLayer(Ogre::Camera* camera, size_t pixelWidth, size_t pixelHeight, float radius, float centralAngle, float height,
+									   Ogre::Vector3 position, Ogre::Quaternion orientation, bool headLocked)
+{
+	VROverlayLayer overlay{};
+	overlay.shape = VROverlayLayer::Shape::Cylinder;
+	overlay.width = pixelWidth;
+	overlay.height = pixelHeight;
+	overlay.size = Ogre::Vector2{ radius * centralAngle, height };
+	overlay.radius = radius;
+	overlay.centralAngle = centralAngle;
+	overlay.position = position;
+	overlay.orientation = orientation;
+	overlay.headLocked = headLocked;
+	return addOverlayLayer(std::move(overlay), camera);
+}
+
+size_t VRRenderer::addOverlayLayer(VROverlayLayer&& overlay, Ogre::Camera* camera)
+{
+	const auto layerIndex = overlayLayers.size();
+	overlay.visible = true;
+	overlay.dirty = true;
+
+	//Each layer has its own small render target, cleared to transparent
+	overlay.texture = root->getTextureManager()->
+		createManual("OVERLAY_LAYER_" + std::to_string(layerIndex),
+					 Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+					 Ogre::TEX_TYPE_2D, Ogre::uint(overlay.width), Ogre::uint(overlay.height), 0,
+					 Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET);
+	memoryTracker.setGpu(GpuMemory::Overlays, "Overlay layer " + std::to_string(layerIndex),
+						 Ogre::PixelUtil::getMemorySize(Ogre::uint32(overlay.width), Ogre::uint32(overlay.height), 1, Ogre::PF_R8G8B8A8));
+
+	auto compositor = root->getCompositorManager2();
+	if (!compositor->hasWorkspaceDefinition(overlayCompositor))
+		createWorkspaceDef(overlayCompositor, "OverlayLayerNode", Ogre::ColourValue{ 0, 0, 0, 0 });
+
+	overlay.camera = camera;
+	updateCameraProjection(camera, Ogre::Real(overlay.width) / Ogre::Real(overlay.height));
+
+	//The workspace stays disabled until the layer is marked dirty
+	overlay.workspace = compositor->addWorkspace(camera->getSceneManager(), overlay.texture->getBuffer()->getRenderTarget(),
+												 camera, overlayCompositor, false);
+
+	overlayLayers.push_back(std::move(overlay));
+	initOverlayLayer(layerIndex);
+	return layerIndex;
+}
+
+void VRRenderer::markLayerDirty(size_t layerIndex)
+{
+	overlayLayers.at(layerIndex).dirty = true;
+}
+
+void VRRenderer::setLayerPose(size_t layerIndex, Ogre::Vector3 position, Ogre::Quaternion orientation)
+{
+	auto& overlay = overlayLayers.at(layerIndex);
+	overlay.position = position;
+	overlay.orientation = orientation;
+}
+
+void VRRenderer::setLayerVisible(size_t layerIndex, bool visible)
+{
+	overlayLayers.at(layerIndex).visible = visible;
+}
+
+void VRRenderer::prepareOverlayLayers()
+{
+	//Idle layers cost nothing : their workspace is not executed, and the runtime keeps their last image
+	for (auto& overlay : overlayLayers)
+		overlay.workspace->setEnabled(overlay.visible && overlay.dirty);
+}
+
+void VRRenderer::setReverseDepth(bool enabled)
+{
+	//The eye projections and the depth format of the eye buffers are picked by initVRHardware
+	if (!eyeBuffers.empty())
+		throw std::runtime_error("Reverse depth can't be switched once the VR hardware is initialised. Call setReverseDepth before initVRHardware");
+
+	reverseDepth = enabled;
+
+	//With a [0; 1] clip range, the precision of the floating point depth is spread evenly across the whole view distance.
+	//The shadow maps keep Ogre's projections and [-1; 1], their passes switch back to it
+	setClipDepthRange(reverseDepth);
+	if (shadowCache) shadowCache->setReverseDepth(reverseDepth);
+
+	//Workspaces read their definitions while executing, so the already created ones follow
+	for (auto clearPassDef : clearPassDefs)
+		clearPassDef->mDepthValue = reverseDepth ? 0.0f : 1.0f;
+	datablocksChanged = true;
+
+	//Everything else rendered by Ogre share the same clip control and datablocks
+	updateCameraProjection(monoCamera, Ogre::Real(width) / Ogre::Real(height));
+	for (auto& overlay : overlayLayers)
+		updateCameraProjection(overlay.camera, Ogre::Real(overlay.width) / Ogre::Real(overlay.height));
+}
+
+void VRRenderer::setFramesInFlight(size_t count)
+{
+	framesInFlight = Ogre::Math::Clamp<size_t>(count, 1, 3);
+}
+
+EyeBufferStats VRRenderer::getEyeBufferStats() const
+{
+	return eyeBufferStats;
+}
+
+void VRRenderer::createEyeBuffers(Ogre::uint bufferWidth, Ogre::uint bufferHeight, Ogre::PixelFormat depthFormat, bool depthTexture)
+{
+	//The masked pixels are filled in by the first pass of the post processing
+	if (radialDensityMask)
+	{
+		if (!postProcess) postProcess = std::make_unique<StereoPostProcess>();
+		postProcess->setSceneFilter(RadialDensityMask::reconstructMaterialName);
+	}
+
+	//The intermediate textures are shared by all the eye buffers, the node definition needs them
+	if (postProcess) postProcess->createResources(bufferWidth, bufferHeight);
+	if (radialDensityMask)
+	{
+		radialDensityMask->createMaterials();
+		radialDensityMask->setEyeFov(eyeFov);
+	}
+
+	auto compositor = root->getCompositorManager2();
+	if (hiddenArea && !hiddenAreaMesh)
+	{
+		hiddenAreaMesh = std::make_unique<HiddenAreaMesh>();
+		for (size_t eye{ 0 }; eye < 2; ++eye)
+		{
+			auto triangles = fetchHiddenAreaMesh(eye);
+			if (triangles.empty()) triangles = HiddenAreaMesh::generate(eyeFov[eye], hiddenAreaRadius);
+			hiddenAreaMesh->setTriangles(eye, triangles);
+		}
+		hiddenAreaMesh->setReverseDepth(reverseDepth);
+
+		//The node definition can only use the custom pass once the compositor knows how to create it
+		compositor->setCompositorPassProvider(hiddenAreaMesh->getPassProvider());
+	}
+	if (!compositor->hasWorkspaceDefinition(stereoscopicCompositor))
+		createStereoWorkspaceDef();
+
+	eyeBuffers.resize(framesInFlight);
+	for (size_t i{ 0 }; i < eyeBuffers.size(); ++i)
+	{
+		auto& eyeBuffer = eyeBuffers[i];
+		eyeBuffer.texture = root->getTextureManager()->
+			createManual("RTT_TEX_HMD_BUFFER_" + std::to_string(i),
+						 Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+						 Ogre::TEX_TYPE_2D, bufferWidth, bufferHeight, 0,
+						 Ogre::PF_R8G8B8A8, Ogre::TU_RENDERTARGET);
+		eyeBuffer.texture->getCustomAttribute("GLID", &eyeBuffer.colorGLID);
+		eyeBuffer.depthGLID = 0;
+		eyeBuffer.depthTarget = GL_TEXTURE_2D;
+		eyeBuffer.fence = nullptr;
+		glGenQueries(1, &eyeBuffer.timerQuery);
+
+		//The HDR texture is only read by the post processing. Flagged as gamma corrected so the HLMS write linear colors to it
+		if (postProcess)
+			eyeBuffer.hdrTexture = root->getTextureManager()->
+				createManual("RTT_TEX_HMD_HDR_" + std::to_string(i),
+							 Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+							 Ogre::TEX_TYPE_2D, bufferWidth, bufferHeight, 0,
+							 StereoPostProcess::hdrFormat, Ogre::TU_RENDERTARGET, nullptr, true);
+
+		//Each buffer gets its own depth pool, otherwise Ogre would share one depth buffer between all of them
+		auto renderTarget = eyeBuffer.texture->getBuffer()->getRenderTarget();
+		auto sceneTarget = postProcess ? eyeBuffer.hdrTexture->getBuffer()->getRenderTarget() : renderTarget;
+		sceneTarget->setDepthBufferPool(Ogre::uint16(eyeBufferDepthPool + i));
+		sceneTarget->setDesiredDepthBufferFormat(depthFormat);
+		sceneTarget->setPreferDepthTexture(depthTexture);
+		if (postProcess) renderTarget->setDepthBufferPool(Ogre::DepthBuffer::POOL_NO_DEPTH);
+
+		memoryTracker.setGpu(GpuMemory::EyeTargets, "Eye buffer " + std::to_string(i),
+							 Ogre::PixelUtil::getMemorySize(bufferWidth, bufferHeight, 1, Ogre::PF_R8G8B8A8) +
+							 Ogre::PixelUtil::getMemorySize(bufferWidth, bufferHeight, 1, depthFormat) +
+							 (postProcess ? Ogre::PixelUtil::getMemorySize(bufferWidth, bufferHeight, 1, StereoPostProcess::hdrFormat) : 0));
+
+		//The eyes are rendered side by side, each scene pass of the workspace names its camera
+		if (postProcess)
+		{
+			Ogre::CompositorChannelVec channels(2);
+			channels[0].target = renderTarget;
+			channels[0].textures.push_back(eyeBuffer.texture);
+			channels[1].target = sceneTarget;
+			channels[1].textures.push_back(eyeBuffer.hdrTexture);
+			postProcess->addChannels(channels);
+			eyeBuffer.workspace = compositor->addWorkspace(smgr, channels, stereoCameras[0], stereoscopicCompositor, false, 1);
+		}
+		else
+			eyeBuffer.workspace = compositor->addWorkspace(smgr, renderTarget, stereoCameras[0], stereoscopicCompositor, false, 1);
+		if (shadowCache) eyeBuffer.workspace->setListener(shadowCache->getWorkspaceListener());
+	}
+
+	currentEyeBuffer = eyeBuffers.size() - 1;
+	eyeBufferStats.framesInFlight = eyeBuffers.size();
+	lastAcquireTime = std::chrono::steady_clock::now();
+}
+
+EyeBuffer& VRRenderer::acquireEyeBuffer()
+{
+	const auto acquireStart = std::chrono::steady_clock::now();
+
+	currentEyeBuffer = (currentEyeBuffer + 1) % eyeBuffers.size();
+	auto& eyeBuffer = eyeBuffers[currentEyeBuffer];
+
+	//Only blocks if the CPU is more than "framesInFlight" frames ahead of the GPU
+	if (eyeBuffer.fence)
+	{
+		while (glClientWaitSync(eyeBuffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(eyeBuffer.fence);
+		eyeBuffer.fence = nullptr;
+
+		//The query ended before the fence, its result is there
+		GLuint64 gpuTime{ 0 };
+		glGetQueryObjectui64v(eyeBuffer.timerQuery, GL_QUERY_RESULT, &gpuTime);
+		eyeBufferStats.lastGpuMs = double(gpuTime) / 1000000;
+		accumulatedGpuMs += eyeBufferStats.lastGpuMs;
+		if (hlmsTierSwitcher) hlmsTierSwitcher->update(eyeBufferStats.lastGpuMs);
+	}
+
+	const auto acquireEnd = std::chrono::steady_clock::now();
+	using milliseconds = std::chrono::duration<double, std::milli>;
+	accumulatedFenceWaitMs += milliseconds(acquireEnd - acquireStart).count();
+	accumulatedFrameMs += milliseconds(acquireStart - lastAcquireTime).count();
+	lastAcquireTime = acquireStart;
+
+	//CPU frame time and fence wait report. Not the motion to photon latency : the runtime's own timing is what measures that
+	if (++accumulatedFrames == eyeBufferReportPeriod)
+	{
+		eyeBufferStats.averageFrameMs = accumulatedFrameMs / accumulatedFrames;
+		eyeBufferStats.averageFenceWaitMs = accumulatedFenceWaitMs / accumulatedFrames;
+		eyeBufferStats.averageGpuMs = accumulatedGpuMs / accumulatedFrames;
+
+		//Formatted in place : the render loop doesn't allocate, even on the frames that report
+		char report[eyeBufferReportSize];
+		snprintf(report, sizeof report, "Eye buffers : %zu in flight, %fms of CPU frame time, %fms of fence wait, %fms of GPU time",
+				 eyeBufferStats.framesInFlight, eyeBufferStats.averageFrameMs, eyeBufferStats.averageFenceWaitMs, eyeBufferStats.averageGpuMs);
+		eyeBufferReport.assign(report);
+		Ogre::LogManager::getSingleton().logMessage(eyeBufferReport);
+		accumulatedFrameMs = accumulatedFenceWaitMs = accumulatedGpuMs = 0;
+		accumulatedFrames = 0;
+	}
+
+	//Once over budget, the frame that went over is the one to look at
+	memoryTracker.update();
+
+	eyeBuffer.workspace->setEnabled(true);
+	if (shadowCache)
+		shadowCache->update(eyeBuffer.workspace->findShadowNode(ShadowCache::shadowNodeName),
+							cameraRig->_getDerivedPositionUpdated(), cameraRig->_getDerivedOrientationUpdated());
+	glBeginQuery(GL_TIME_ELAPSED, eyeBuffer.timerQuery);
+	return eyeBuffer;
+}
+
+void VRRenderer::releaseEyeBuffer()
+{
+	auto& eyeBuffer = eyeBuffers[currentEyeBuffer];
+	glEndQuery(GL_TIME_ELAPSED);
+	eyeBuffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	eyeBuffer.workspace->setEnabled(false);
+}
+
+GLuint VRRenderer::getDepthGLID(EyeBuffer& eyeBuffer)
+{
+	const auto& sceneTexture = eyeBuffer.hdrTexture.isNull() ? eyeBuffer.texture : eyeBuffer.hdrTexture;
+	if (!eyeBuffer.depthGLID)
+		if (auto depthBuffer = static_cast<Ogre::GL3PlusDepthBuffer*>(sceneTexture->getBuffer()->getRenderTarget()->getDepthBuffer()))
+		{
+			//The name is a renderbuffer's when the pool already had a depth buffer that is not a texture
+			eyeBuffer.depthGLID = depthBuffer->getDepthBuffer();
+			eyeBuffer.depthTarget = depthBuffer->isDepthTexture() ? GL_TEXTURE_2D : GL_RENDERBUFFER;
+		}
+
+	return eyeBuffer.depthGLID;
+}
+
+void VRRenderer::createWorkspaceDef(Ogre::IdString workspaceName, const Ogre::String& nodeName, const Ogre::ColourValue& clearColor)
+{
+	auto compositor = root->getCompositorManager2();
+
+	//Same thing as createBasicWorkspaceDef, but we keep control on the clear pass
+	auto nodeDef = compositor->addNodeDefinition(nodeName);
+	nodeDef->addTextureSourceName("renderwindow", 0, Ogre::TextureDefinitionBase::TEXTURE_INPUT);
+	nodeDef->setNumTargetPass(1);
+
+	auto targetDef = nodeDef->addTargetPass("renderwindow");
+	targetDef->setNumPasses(2);
+
+	auto clearDef = static_cast<Ogre::CompositorPassClearDef*>(targetDef->addPass(Ogre::PASS_CLEAR));
+	clearDef->mColourValue = clearColor;
+	clearDef->mDepthValue = reverseDepth ? 0.0f : 1.0f;
+	clearPassDefs.push_back(clearDef);
+
+	targetDef->addPass(Ogre::PASS_SCENE);
+
+	auto workspaceDef = compositor->addWorkspaceDefinition(workspaceName);
+	workspaceDef->connectExternal(0, nodeName, 0);
+}
+
+void VRRenderer::createStereoWorkspaceDef()
+{
+	auto compositor = root->getCompositorManager2();
+	const Ogre::String nodeName{ "StereoscopicNode" };
+	if (shadowCache) shadowCache->createShadowNodeDef(compositor);
+
+	auto nodeDef = compositor->addNodeDefinition(nodeName);
+	nodeDef->addTextureSourceName("renderwindow", 0, Ogre::TextureDefinitionBase::TEXTURE_INPUT);
+	nodeDef->setNumTargetPass(1);
+
+	auto targetDef = nodeDef->addTargetPass("renderwindow");
+	targetDef->setNumPasses(3 + (hiddenAreaMesh ? 1 : 0) + (radialDensityMask ? RadialDensityMask::maskPassCount + 1 : 0));
+
+	auto clearDef = static_cast<Ogre::CompositorPassClearDef*>(targetDef->addPass(Ogre::PASS_CLEAR));
+	clearDef->mColourValue = backgroundColor;
+	clearDef->mDepthValue = reverseDepth ? 0.0f : 1.0f;
+	clearPassDefs.push_back(clearDef);
+
+	//The hidden area is at the near plane before anything else : the scene fails the depth test there, before its pixel shaders run
+	if (hiddenAreaMesh) HiddenAreaMesh::addPass(targetDef);
+	if (radialDensityMask) RadialDensityMask::addMaskPasses(targetDef);
+
+	for (size_t eye{ 0 }; eye < 2; ++eye)
+	{
+		auto sceneDef = static_cast<Ogre::CompositorPassSceneDef*>(targetDef->addPass(Ogre::PASS_SCENE));
+		sceneDef->mCameraName = stereoCameras[eye]->getName();
+		sceneDef->mVpLeft = 0.5f * eye;
+		sceneDef->mVpWidth = 0.5f;
+
+		//The LODs are picked once, from the center of the rig : the eyes can't disagree on them
+		if (eye == 0) sceneDef->mLodCameraName = lodCamera->getName();
+		else sceneDef->mUpdateLodLists = false;
+
+		//The left eye computes the cascades, the right eye uses them as they are. Never one set of shadow maps per eye
+		if (shadowCache)
+		{
+			sceneDef->mShadowNode = ShadowCache::shadowNodeName;
+			sceneDef->mShadowNodeRecalculation = eye == 0 ? Ogre::SHADOW_NODE_FIRST_ONLY : Ogre::SHADOW_NODE_REUSE;
+		}
+	}
+
+	if (radialDensityMask) RadialDensityMask::addStencilOffPass(targetDef);
+
+	auto workspaceDef = compositor->addWorkspaceDefinition(stereoscopicCompositor);
+	if (postProcess)
+	{
+		nodeDef->mapOutputChannel(0, "renderwindow");
+		postProcess->createNodeDef(compositor, workspaceDef, nodeName, hiddenAreaMesh != nullptr);
+	}
+	else
+		workspaceDef->connectExternal(0, nodeName, 0);
+}
+
+void VRRenderer::applyReverseDepthToDatablocks()
+{
+	//Only walk the datablocks when some may have been created : resource groups, attached items, notifyDatablocksCreated
+	if (!datablocksChanged) return;
+	datablocksChanged = false;
+
+	const auto setDepthFunction = [this](Ogre::HlmsTypes type, Ogre::HlmsDatablock* datablock)
+	{
+		//Only the regular macroblock, shadow casters are rendered with Ogre's projections and the [-1; 1] clip range
+		auto macroblock = *datablock->getMacroblock(false);
+		const auto key = std::make_pair(type, datablock->getName());
+		const auto reversed = reversedDatablocks.find(key);
+		if (reverseDepth && reversed == reversedDatablocks.end())
+		{
+			if (macroblock.mDepthFunc == Ogre::CMPF_LESS) macroblock.mDepthFunc = Ogre::CMPF_GREATER;
+			else if (macroblock.mDepthFunc == Ogre::CMPF_LESS_EQUAL) macroblock.mDepthFunc = Ogre::CMPF_GREATER_EQUAL;
+			else return;
+			reversedDatablocks.insert(key);
+		}
+		else if (!reverseDepth && reversed != reversedDatablocks.end())
+		{
+			if (macroblock.mDepthFunc == Ogre::CMPF_GREATER) macroblock.mDepthFunc = Ogre::CMPF_LESS;
+			else if (macroblock.mDepthFunc == Ogre::CMPF_GREATER_EQUAL) macroblock.mDepthFunc = Ogre::CMPF_LESS_EQUAL;
+			reversedDatablocks.erase(reversed);
+		}
+		else return;
+		datablock->setMacroblock(macroblock);
+	};
+
+	auto hlmsManager = root->getHlmsManager();
+	for (auto type : { Ogre::HLMS_PBS, Ogre::HLMS_UNLIT, HlmsTierSwitcher::mobilePbsType, HlmsTierSwitcher::mobileUnlitType })
+		if (auto hlms = hlmsManager->getHlms(type))
+		{
+			setDepthFunction(type, hlms->getDefaultDatablock());
+			for (const auto& entry : hlms->getDatablockMap())
+				setDepthFunction(type, entry.second.datablock);
+		}
+}
+
+void VRRenderer::notifyDatablocksCreated()
+{
+	datablocksChanged = true;
+}
+
+void VRRenderer::updateCameraProjection(Ogre::Camera* camera, Ogre::Real aspect)
+{
+	if (!reverseDepth)
+	{
+		camera->setCustomProjectionMatrix(false);
+
+		//Give back the far plane the infinite projection replaced
+		const auto farClip = reverseDepthFarClips.find(camera);
+		if (farClip != reverseDepthFarClips.end())
+		{
+			camera->setFarClipDistance(farClip->second);
+			reverseDepthFarClips.erase(farClip);
+		}
+		return;
+	}
+
+	//Right handed, depth goes from 1 at the near plane to 0 at the far plane
+	if (camera->getProjectionType() == Ogre::PT_ORTHOGRAPHIC)
+	{
+		const auto n = camera->getNearClipDistance();
+		const auto f = camera->getFarClipDistance();
+		const Ogre::Matrix4 projection
+		{
+			2 / camera->getOrthoWindowWidth(), 0, 0, 0,
+			0, 2 / camera->getOrthoWindowHeight(), 0, 0,
+			0, 0, 1 / (f - n), f / (f - n),
+			0, 0, 0, 1
+		};
+		camera->setCustomProjectionMatrix(true, projection);
+		return;
+	}
+
+	//Perspective cameras get an infinite far plane
+	const auto f = 1 / Ogre::Math::Tan(camera->getFOVy() / 2);
+	const Ogre::Matrix4 projection
+	{
+		f / aspect, 0, 0, 0,
+		0, f, 0, 0,
+		0, 0, 0, camera->getNearClipDistance(),
+		0, 0, -1, 0
+	};
+
+	reverseDepthFarClips.emplace(camera, camera->getFarClipDistance());
+	camera->setFarClipDistance(0);
+	camera->setCustomProjectionMatrix(true, projection);
+}
+
+PosePredictor& VRRenderer::getHeadPosePredictor()
+{
+	return headPosePredictor;
+}
+
+void VRRenderer::attachTrackedDevice(VRDevice device, Ogre::SceneNode* node)
+{
+	trackedDeviceNodes[size_t(device)] = node;
+}
+
+void VRRenderer::detachTrackedDevice(VRDevice device)
+{
+	trackedDeviceNodes[size_t(device)] = nullptr;
+}
+
+bool VRRenderer::isDeviceTracked(VRDevice device) const
+{
+	return trackedDeviceValid[size_t(device)];
+}
+
+const VRPose& VRRenderer::getDevicePose(VRDevice device) const
+{
+	return trackedDevicePoses[size_t(device)];
+}
+
+uint32_t VRRenderer::getControllerButtons(VRDevice device) const
+{
+	return controllerButtons[size_t(device)];
+}
+
+void VRRenderer::setDevicePose(VRDevice device, bool tracked, const VRPose& pose, uint32_t buttons)
+{
+	const auto index = size_t(device);
+	auto& devicePose = trackedDevicePoses[index];
+
+	//A device missing from the trace is not tracked during the replay
+	if (isReplayingPoses())
+		tracked = replayPose(device, devicePose);
+	else if (tracked)
+		devicePose = pose;
+
+	if (tracked) recordPose(device, devicePose);
+	trackedDeviceValid[index] = tracked;
+	controllerButtons[index] = buttons;
+}
+
+void VRRenderer::applyTrackedDevicePoses()
+{
+	//Untracked devices keep their last known pose
+	for (size_t i{ 0 }; i < deviceCount; ++i)
+		if (trackedDeviceNodes[i] && trackedDeviceValid[i])
+		{
+			trackedDeviceNodes[i]->setOrientation(trackedDevicePoses[i].orientation);
+			trackedDeviceNodes[i]->setPosition(trackedDevicePoses[i].position);
+		}
+}
+
+void VRRenderer::startPoseRecording(const std::string& path)
+{
+	poseRecorder = std::make_unique<PoseRecorder>(path);
+	trackingFrame = 0;
+}
+
+void VRRenderer::stopPoseRecording()
+{
+	poseRecorder.reset();
+}
+
+void VRRenderer::startPoseReplay(const std::string& path)
+{
+	posePlayer = std::make_unique<PosePlayer>(path);
+	trackingFrame = 0;
+}
+
+bool VRRenderer::isReplayingPoses() const
+{
+	return posePlayer != nullptr;
+}
+
+bool VRRenderer::replayPose(VRDevice device, VRPose& pose)
+{
+	return posePlayer && posePlayer->pose(trackingFrame, device, pose);
+}
+
+void VRRenderer::recordPose(VRDevice device, const VRPose& pose)
+{
+	if (poseRecorder) poseRecorder->record(trackingFrame, device, pose);
+}
+
+void VRRenderer::nextTrackingFrame()
+{
+	++trackingFrame;
+
+	if (posePlayer && posePlayer->isFinished(trackingFrame))
+	{
+		logToOgre("Pose trace finished after " + std::to_string(trackingFrame) + " frames");
+		posePlayer.reset();
+		running = false;
+	}
+}
+
+TextureStreamer* VRRenderer::getTextureStreamer()
+{
+	//4MiB per frame is about a 1024x1024 mipmap, that's less than a millisecond of upload on a VR capable card
+	if (!textureStreamer)
+		textureStreamer = std::make_unique<TextureStreamer>(threads, 4 * 1024 * 1024);
+	return textureStreamer.get();
+}
+
+void VRRenderer::updateTextureStreaming()
+{
+	if (textureStreamer)
+		textureStreamer->update(cameraRig->_getDerivedPosition(), pixelsPerTangent);
+}
+
+void VRRenderer::setMeshLod(size_t levels, Ogre::Real keepPerLevel, Ogre::Real maxPixelError)
+{
+	meshLodLevels = levels;
+	meshLodKeepPerLevel = Ogre::Math::Clamp<Ogre::Real>(keepPerLevel, 0.05f, 0.95f);
+	meshLodMaxPixelError = std::max<Ogre::Real>(0.1f, maxPixelError);
+}
+
+void VRRenderer::setIndexOptimisation(bool enable, bool reduceOverdraw, size_t cacheSize)
+{
+	indexOptimisation = enable;
+	indexOptimisationOverdraw = reduceOverdraw;
+	indexOptimisationCacheSize = std::max<size_t>(4, cacheSize);
+}
+
+void VRRenderer::setVertexCompression(const VertexCompression& options)
+{
+	vertexCompression = options;
+}
+
+Ogre::SceneNode* VRRenderer::attachItem(Ogre::SceneNode* node, Ogre::Item* item)
+{
+	const auto dequantisation = meshDequantisation.find(item->getMesh()->getName());
+	if (dequantisation != meshDequantisation.end())
+	{
+		const auto& transform = dequantisation->second;
+		node = node->createChildSceneNode();
+		node->setPosition(transform.x, transform.y, transform.z);
+		node->setScale(Ogre::Vector3(transform.w));
+		if (item->getListener() == VertexCompressor::getDequantisationCheck()) item->setListener(nullptr);
+	}
+
+	node->attachObject(item);
+	datablocksChanged = true;
+	return node;
+}
+
+Ogre::MeshPtr VRRenderer::asV2mesh(Ogre::String meshName, Ogre::String ResourceGroup, Ogre::String sufix,
+								   bool halfPos, bool halfTextCoords, bool qTangents)
+{
+	//Normalized positions are made from the full precision ones. Packed normals replace the QTangents
+	halfPos = halfPos && !vertexCompression.normalizedPositions;
+	qTangents = qTangents && !vertexCompression.octahedralNormals && !vertexCompression.packedNormals;
+
+	//Everything that changes the result is in the name of the cached file
+	const auto settings = std::to_string(halfPos) + std::to_string(halfTextCoords) + std::to_string(qTangents) + "_"
+		+ std::to_string(meshLodLevels) + "_" + std::to_string(meshLodKeepPerLevel) + "_"
+		+ std::to_string(meshLodMaxPixelError) + "_" + std::to_string(pixelsPerTangent) + "_"
+		+ std::to_string(vertexCompression.normalizedPositions) + std::to_string(vertexCompression.octahedralNormals)
+		+ std::to_string(vertexCompression.packedNormals) + std::to_string(vertexCompression.reorderVertices) + "_"
+		+ std::to_string(indexOptimisation) + std::to_string(indexOptimisationOverdraw) + std::to_string(indexOptimisationCacheSize);
+	const auto cachePath = Ogre::String{ meshCacheFolder } + "/" + meshName + "." + std::to_string(std::hash<std::string>{}(settings)) + ".mesh";
+	//The mesh file has no room for the dequantisation of normalized positions
+	const auto dequantisationPath = cachePath + ".dequant";
+
+	auto& resourceGroupManager = Ogre::ResourceGroupManager::getSingleton();
+	const auto sourceGroup = resourceGroupManager.findGroupContainingResource(meshName);
+	struct _stat cacheStat;
+	const auto cached = _stat(cachePath.c_str(), &cacheStat) == 0 &&
+		cacheStat.st_mtime >= resourceGroupManager.resourceModifiedTime(sourceGroup, meshName);
+
+	auto vaoManager = root->getRenderSystem()->getVaoManager();
+	auto mesh = Ogre::MeshManager::getSingletonPtr()->createManual(meshName + sufix, ResourceGroup);
+
+	//Simplifying a mesh takes a while, loading the result doesn't
+	if (cached)
+	{
+		Ogre::DataStreamPtr stream(OGRE_NEW Ogre::FileStreamDataStream(OGRE_NEW_T(std::ifstream, Ogre::MEMCATEGORY_GENERAL)(cachePath, std::ios::binary)));
+		Ogre::MeshSerializer(vaoManager).importMesh(stream, mesh.get());
+
+		std::ifstream dequantisationFile(dequantisationPath);
+		Ogre::Vector4 dequantisation;
+		if (dequantisationFile >> dequantisation.x >> dequantisation.y >> dequantisation.z >> dequantisation.w)
+			meshDequantisation[mesh->getName()] = dequantisation;
+		memoryTracker.setGpu(GpuMemory::Meshes, mesh->getName(), meshBufferBytes(mesh));
+		mesh->addListener(memoryTracker.getUnloadListener(GpuMemory::Meshes));
+		return mesh;
+	}
+
+	//Get the V1 mesh
+	auto v1mesh = loadV1mesh(meshName);
+
+	if (meshLodLevels)
+	{
+		if (!meshLodGenerator) meshLodGenerator = std::make_unique<Ogre::MeshLodGenerator>();
+
+		size_t vertexCount{ v1mesh->sharedVertexData[Ogre::VpNormal] ? v1mesh->sharedVertexData[Ogre::VpNormal]->vertexCount : 0 };
+		for (unsigned short i{ 0 }; i < v1mesh->getNumSubMeshes(); ++i)
+		{
+			const auto subMesh = v1mesh->getSubMesh(i);
+			if (!subMesh->useSharedVertices) vertexCount += subMesh->vertexData[Ogre::VpNormal]->vertexCount;
+		}
+
+		//The error of a level is about the spacing of its vertices over the bounding sphere.
+		//It covers "maxPixelError" pixels of the eye buffers at "spacing * pixelsPerTangent / maxPixelError" from the head
+		Ogre::LodConfig config(v1mesh);
+		//Compressed LODs share ranges of one index buffer, reordering a level would scramble the others
+		config.advanced.useCompression = !indexOptimisation;
+		Ogre::Real keep{ 1 };
+		for (size_t level{ 0 }; level < meshLodLevels; ++level)
+		{
+			keep *= meshLodKeepPerLevel;
+			const auto remainingVertices = std::max<Ogre::Real>(4, vertexCount * keep);
+			const auto spacing = v1mesh->getBoundingSphereRadius() * Ogre::Math::Sqrt(4 * Ogre::Math::PI / remainingVertices);
+			config.createGeneratedLodLevel(spacing * pixelsPerTangent / meshLodMaxPixelError, 1 - keep, Ogre::LodLevel::VRM_PROPORTIONAL);
+		}
+		meshLodGenerator->generateLodLevels(config);
+	}
+
+	//Blender exports the triangles in modelling order, not in an order the vertex cache likes
+	if (indexOptimisation)
+		IndexOptimiser::optimiseMesh(v1mesh.get(), indexOptimisationCacheSize, indexOptimisationOverdraw);
+
+	//Convert it as a V2 mesh
+	mesh->importV1(v1mesh.get(), halfPos, halfTextCoords, qTangents);
+
+	//Remove the useless V1 mesh. Only unloading it would leave it in the V1 mesh manager
+	Ogre::v1::MeshManager::getSingleton().remove(v1mesh->getHandle());
+	v1mesh.setNull();
+
+	if (vertexCompression.any())
+	{
+		Ogre::Vector4 dequantisation{ 0, 0, 0, 0 };
+		const auto report = VertexCompressor::compress(mesh.get(), vaoManager, vertexCompression, dequantisation);
+		if (dequantisation.w > 0)
+		{
+			meshDequantisation[mesh->getName()] = dequantisation;
+			std::ofstream(dequantisationPath) << dequantisation.x << " " << dequantisation.y << " " << dequantisation.z << " " << dequantisation.w;
+		}
+		else
+			DeleteFileA(dequantisationPath.c_str());
+
+		//Only the size is known here. What it gains in vertex fetch depends on the GPU and on the mesh, measure it with the GPU timer
+		if (report.vertexBytesAfter)
+			logToOgre(meshName + " vertex compression : " + std::to_string(report.vertexCount) + " vertices, "
+					  + std::to_string(report.vertexBytesBefore) + " -> " + std::to_string(report.vertexBytesAfter) + " bytes ("
+					  + std::to_string(report.vertexBytesBefore - report.vertexBytesAfter) + " saved), "
+					  + std::to_string(double(report.vertexBytesBefore) / report.vertexBytesAfter) + "x smaller vertex buffers");
+	}
+
+	//A failing cache only costs the generation next time
+	CreateDirectoryA(meshCacheFolder, nullptr);
+	try
+	{
+		Ogre::MeshSerializer(vaoManager).exportMesh(mesh.get(), cachePath);
+	}
+	catch (const Ogre::Exception& e)
+	{
+		logToOgre("Cannot cache " + meshName + " : " + e.getDescription());
+	}
+
+	memoryTracker.setGpu(GpuMemory::Meshes, mesh->getName(), meshBufferBytes(mesh));
+	mesh->addListener(memoryTracker.getUnloadListener(GpuMemory::Meshes));
+
+	//Return the shared pointer to the new mesh
+	return mesh;
+}
+
+void VRRenderer::setHlmsHotReload(bool enable)
+{
+	hlmsHotReloader.reset();
+	if (enable)
+		hlmsHotReloader = std::make_unique<HlmsHotReloader>(root->getHlmsManager());
+}
+
+void VRRenderer::reloadChangedHlms()
+{
+	//The shaders are compiled again as the eyes need them. The headset keeps reprojecting the last frame meanwhile
+	if (hlmsHotReloader)
+		hlmsHotReloader->update();
+}
+
+StereoPassListener* VRRenderer::getStereoPassListener()
+{
+	return stereoPassListener.get();
+}
+
+void VRRenderer::setStereoLightGrid(bool enable, Ogre::uint32 gridWidth, Ogre::uint32 gridHeight, Ogre::uint32 numSlices,
+									Ogre::uint32 lightsPerCell, float minDistance, float maxDistance)
+{
+	//Never both : the lights would be shaded twice
+	smgr->setForward3D(false, gridWidth, gridHeight, numSlices, lightsPerCell, minDistance, maxDistance);
+
+	stereoLightGrid.reset();
+	if (enable)
+		stereoLightGrid = std::make_unique<StereoLightGrid>(cameraRig, stereoCameras, gridWidth, gridHeight, numSlices,
+															lightsPerCell, minDistance, maxDistance);
+	if (stereoPassListener) stereoPassListener->setLightGrid(stereoLightGrid.get());
+}
+
+StereoLightGrid* VRRenderer::getStereoLightGrid()
+{
+	return stereoLightGrid.get();
+}
+
+MemoryTracker& VRRenderer::getMemoryTracker()
+{
+	return memoryTracker;
+}
+
+LinearArena& VRRenderer::getFrameArena()
+{
+	return frameArena;
+}
+
+void VRRenderer::setShadows(bool enable, size_t cascades, Ogre::uint32 resolution, Ogre::Real distance, size_t firstCachedCascade)
+{
+	shadowCache.reset();
+	if (!enable) return;
+
+	//The eye projections can have an infinite far plane, the PSSM splits need a finite one
+	smgr->setShadowFarDistance(distance);
+	shadowCache = std::make_unique<ShadowCache>(cascades, resolution, firstCachedCascade);
+	shadowCache->setReverseDepth(reverseDepth);
+}
+
+ShadowCache* VRRenderer::getShadowCache()
+{
+	return shadowCache.get();
+}
+
+void VRRenderer::setPostProcessing(bool enable)
+{
+	if (!enable) postProcess.reset();
+	else if (!postProcess) postProcess = std::make_unique<StereoPostProcess>();
+}
+
+StereoPostProcess* VRRenderer::getPostProcess()
+{
+	return postProcess.get();
+}
+
+void VRRenderer::setRadialDensityMask(bool enable, float radius)
+{
+	radialDensityMask.reset();
+	if (enable) radialDensityMask = std::make_unique<RadialDensityMask>(radius);
+}
+
+RadialDensityMask* VRRenderer::getRadialDensityMask()
+{
+	return radialDensityMask.get();
+}
+
+void VRRenderer::setHiddenAreaMesh(bool enable, float radius)
+{
+	//The mesh owns GL objects, it is created with the eye buffers
+	hiddenArea = enable;
+	hiddenAreaRadius = radius;
+}
+
+HiddenAreaMesh* VRRenderer::getHiddenAreaMesh()
+{
+	return hiddenAreaMesh.get();
+}
+
+std::vector<Ogre::Vector2> VRRenderer::fetchHiddenAreaMesh(size_t)
+{
+	return {};
+}
+
+HlmsTierSwitcher* VRRenderer::getHlmsTierSwitcher()
+{
+	if (!hlmsTierSwitcher)
+		hlmsTierSwitcher = std::make_unique<HlmsTierSwitcher>(root->getHlmsManager());
+	return hlmsTierSwitcher.get();
+}
+
+void VRRenderer::beginFrameUploads()
+{
+	if (!stereoPassListener)
+		stereoPassListener = std::make_unique<StereoPassListener>();
+
+	//declareHlmsLibrary is static and called after the renderer is created, so the listener is attached here
+	auto hlmsManager = root->getHlmsManager();
+	for (auto type : { Ogre::HLMS_PBS, Ogre::HLMS_UNLIT })
+		if (auto hlms = hlmsManager->getHlms(type))
+			if (hlms->getListener() != stereoPassListener.get())
+				hlms->setListener(stereoPassListener.get());
+
+	stereoPassListener->setLightGrid(stereoLightGrid.get());
+	if (stereoLightGrid) stereoLightGrid->beginFrame();
+}
+
+void VRRenderer::endFrameUploads()
+{
+	if (stereoLightGrid) stereoLightGrid->endFrame();
+}
+
+void VRRenderer::addResourceLocation(const Ogre::String& location, const Ogre::String& type, const Ogre::String& group)
+{
+	pendingResourceLocations.push_back({ location, type, group });
+}
+
+void VRRenderer::requireResourceGroup(const Ogre::String& group)
+{
+	auto& resourceGroupManager = Ogre::ResourceGroupManager::getSingleton();
+
+	//Index the locations of the group now. Ogre does it synchronously in addResourceLocation
+	bool declared{ false };
+	for (auto it = pendingResourceLocations.begin(); it != pendingResourceLocations.end();)
+	{
+		if (it->group != group) { ++it; continue; }
+		resourceGroupManager.addResourceLocation(it->location, it->type, it->group);
+		it = pendingResourceLocations.erase(it);
+		declared = true;
+	}
+
+	if (declared && !resourceGroupManager.isResourceGroupInitialised(group))
+	{
+		//Its material scripts create datablocks
+		resourceGroupManager.initialiseResourceGroup(group);
+		datablocksChanged = true;
+	}
+}
+
+bool VRRenderer::hasPendingResourceGroups() const
+{
+	return !pendingResourceLocations.empty();
+}
+
+std::chrono::milliseconds VRRenderer::getTimeToFirstFrame() const
+{
+	return timeToFirstFrame;
+}
+
+void VRRenderer::frameSubmitted()
+{
+	if (!firstFrameSubmitted)
+	{
+		firstFrameSubmitted = true;
+		timeToFirstFrame = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+		logToOgre("Time to first headset frame : " + std::to_string(timeToFirstFrame.count()) + "ms");
+	}
+
+	//Ogre's ResourceGroupManager is not thread safe, so the "background" work is one group per frame on this thread
+	if (!pendingResourceLocations.empty())
+		requireResourceGroup(Ogre::String{ pendingResourceLocations.front().group });
+
+	//Nothing allocated during the frame is used past this point
+	frameArena.reset();
 }
 
 void VRRenderer::updateEvents()
@@ -152,26 +1198,49 @@ void VRRenderer::declareHlmsLibrary(const Ogre::String&& path)
 		throw std::runtime_error("This function is OpenGL only. Please use the RenderSytem_GL3+ in the Ogre configuration!");
 #endif
 	auto hlmsFolder = path;
+	Ogre::String archiveType{ "FileSystem" };
 
+	//A packed library is one mapped file, made at build time. Its folders are read like the loose ones
+	const Ogre::String packExtension{ ".hlmspack" };
+	if (hlmsFolder.size() > packExtension.size() &&
+		hlmsFolder.compare(hlmsFolder.size() - packExtension.size(), packExtension.size(), packExtension) == 0)
+	{
+		static HlmsPackArchiveFactory packFactory;
+		static bool packFactoryAdded{ false };
+		if (!packFactoryAdded)
+		{
+			Ogre::ArchiveManager::getSingleton().addArchiveFactory(&packFactory);
+			packFactoryAdded = true;
+		}
+		hlmsFolder += HlmsPackArchive::separator;
+		archiveType = HlmsPackArchive::type;
+	}
 	//The hlmsFolder can come from a configuration file where it could be "empty" or set to "." or lacking the trailing "/"
-	if (hlmsFolder.empty()) hlmsFolder = "./";
+	else if (hlmsFolder.empty()) hlmsFolder = "./";
 	else if (hlmsFolder[hlmsFolder.size() - 1] != '/') hlmsFolder += "/";
 
 	//Get the hlmsManager (not a singleton by itself, but accessible via Root)
 	auto hlmsManager = Ogre::Root::getSingleton().getHlmsManager();
+	const auto loadArchive = [&](const Ogre::String& folder)
+	{
+		return Ogre::ArchiveManager::getSingletonPtr()->load(hlmsFolder + folder + SL, archiveType, true);
+	};
 
 	//Define the shader library to use for HLMS
 	auto library = Ogre::ArchiveVec();
-	auto archiveLibrary = Ogre::ArchiveManager::getSingletonPtr()->load(hlmsFolder + "Hlms/Common/" + SL, "FileSystem", true);
+	auto archiveLibrary = loadArchive("Hlms/Common/");
 	library.push_back(archiveLibrary);
 
 	//Define "unlit" and "PBS" (physics based shader) HLMS
-	auto archiveUnlit = Ogre::ArchiveManager::getSingletonPtr()->load(hlmsFolder + "Hlms/Unlit/" + SL, "FileSystem", true);
-	auto archivePbs = Ogre::ArchiveManager::getSingletonPtr()->load(hlmsFolder + "Hlms/Pbs/" + SL, "FileSystem", true);
+	auto archiveUnlit = loadArchive("Hlms/Unlit/");
+	auto archivePbs = loadArchive("Hlms/Pbs/");
 	auto hlmsUnlit = OGRE_NEW Ogre::HlmsUnlit(archiveUnlit, &library);
-	auto hlmsPbs = OGRE_NEW Ogre::HlmsPbs(archivePbs, &library);
+	auto hlmsPbs = VertexCompressor::createHlmsPbs(archivePbs, &library);
 	hlmsManager->registerHlms(hlmsUnlit);
 	hlmsManager->registerHlms(hlmsPbs);
+
+	//The cheaper shading path, for the materials on the mobile tier
+	HlmsTierSwitcher::registerMobileHlms(hlmsManager, loadArchive("Hlms/PbsMobile/"), loadArchive("Hlms/UnlitMobile/"), library);
 }
 
 Ogre::Root* VRRenderer::getOgreRoot() const
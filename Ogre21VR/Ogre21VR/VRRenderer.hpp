@@ -17,6 +17,14 @@
 #include <memory>
 #include <array>
 #include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <set>
+#include <sys/stat.h>
 
 //Ogre 2 libraries
 #include <OGRE/Ogre.h>
@@ -26,9 +34,19 @@
 #include <OGRE/OgreMeshManager2.h>
 #include <OGRE/OgreMesh.h>
 #include <OGRE/OgreMesh2.h>
+#include <OGRE/OgreMesh2Serializer.h>
+#include <OGRE/OgreSubMesh2.h>
+#include <OGRE/Vao/OgreVertexArrayObject.h>
+#include <OGRE/Vao/OgreVertexBufferPacked.h>
+#include <OGRE/Vao/OgreIndexBufferPacked.h>
+#include <OGRE/MeshLodGenerator/OgreMeshLodGenerator.h>
+#include <OGRE/MeshLodGenerator/OgreLodConfig.h>
 #include <OGRE/Compositor/OgreCompositorManager2.h>
 #include <OGRE/Compositor/OgreCompositorWorkspaceDef.h>
 #include <OGRE/Compositor/OgreCompositorWorkspace.h>
+#include <OGRE/Compositor/OgreCompositorNodeDef.h>
+#include <OGRE/Compositor/Pass/PassClear/OgreCompositorPassClearDef.h>
+#include <OGRE/Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h>
 #include <OGRE/Hlms/Pbs/OgreHlmsPbs.h>
 #include <OGRE/Hlms/Unlit/OgreHlmsUnlit.h>
 #include <OGRE/OgreHlmsManager.h>
@@ -36,6 +54,84 @@
 #include <OGRE/OgreItem.h>
 #include <OGRE/OgreLight.h>
 
+//Access to the GL name of the depth buffers Ogre renders into
+#include <OGRE/RenderSystems/GL3Plus/OgreGL3PlusDepthBuffer.h>
+
+#include "TextureStreamer.hpp"
+#include "StereoPassListener.hpp"
+#include "StereoLightGrid.hpp"
+#include "ClipControl.hpp"
+#include "ShadowCache.hpp"
+#include "StereoPostProcess.hpp"
+#include "RadialDensityMask.hpp"
+#include "HiddenAreaMesh.hpp"
+#include "HlmsTierSwitcher.hpp"
+#include "HlmsPackArchive.hpp"
+#include "HlmsHotReloader.hpp"
+#include "VertexCompressor.hpp"
+#include "IndexOptimiser.hpp"
+#include "MemoryTracker.hpp"
+#include "FrameArena.hpp"
+#include "PosePredictor.hpp"
+#include "PoseRecorder.hpp"
+
+///A 2D layer composited by the VR runtime on top of the eye buffers (HUD, menus...)
+struct VROverlayLayer
+{
+	enum class Shape { Quad, Cylinder };
+
+	Shape shape;
+	///Size of the texture in pixels
+	size_t width, height;
+	///Quad : size in meters. Cylinder : x is unused, y is the height in meters
+	Ogre::Vector2 size;
+	///Cylinder only : radius in meters and visible arc in radians
+	float radius, centralAngle;
+	///Pose of the center of the layer, in tracking space (or head space if head locked)
+	Ogre::Vector3 position;
+	Ogre::Quaternion orientation;
+	bool headLocked;
+	bool visible;
+	///The content needs to be rendered and sent again to the runtime
+	bool dirty;
+
+	Ogre::Camera* camera;
+	Ogre::TexturePtr texture;
+	Ogre::CompositorWorkspace* workspace;
+};
+
+///One render target holding both eyes. There is one per frame in flight
+struct EyeBuffer
+{
+	Ogre::TexturePtr texture;
+	///The eyes are rendered to this one, with its depth buffer, when post processing is enabled. Null otherwise
+	Ogre::TexturePtr hdrTexture;
+	///Renders the left eye to the left half of the texture and the right eye to the right half, with the same shadow maps
+	Ogre::CompositorWorkspace* workspace;
+	GLuint colorGLID;
+	///Only known after the first render, Ogre attaches depth buffers lazily
+	GLuint depthGLID;
+	///GL_TEXTURE_2D, or GL_RENDERBUFFER when Ogre didn't honour the depth texture preference
+	GLenum depthTarget;
+	///Signaled once the GPU has finished reading the buffer for the VR runtime
+	GLsync fence;
+	///GPU time of the frame rendered in this buffer. Read back once the fence is signaled, so it never stalls
+	GLuint timerQuery;
+};
+
+///How the eye buffer ring is behaving
+struct EyeBufferStats
+{
+	size_t framesInFlight;
+	///Average CPU time between two frames
+	double averageFrameMs;
+	///Average time spent waiting for the GPU to release the next eye buffer
+	double averageFenceWaitMs;
+	///GPU time spent rendering the eyes, averaged and for the last frame read back
+	double averageGpuMs;
+	double lastGpuMs;
+};
+
 ///VRRenderer abstract class
 class VRRenderer
 {
@@ -56,6 +152,106 @@ public:
 	void setNearClippingDistance(double d);
 	///Set the far clipping distance
 	void setFarClippingDistance(double d);
+	///Also submit the eye depth buffer to the VR runtime, so it can do positional reprojection. Call this before initVRHardware
+	void setDepthSubmission(bool enabled);
+	///Use a reversed, floating point depth buffer with an infinite far plane for the eyes. Call this before initVRHardware, throws after it
+	void setReverseDepth(bool enabled);
+	///Datablocks from material scripts and attachItem get the reversed depth. Call this after creating some in code
+	void notifyDatablocksCreated();
+	///Number of eye buffers the CPU can render ahead of the GPU, between 1 and 3. Call this before initVRHardware
+	void setFramesInFlight(size_t count);
+	///Return the frame time and GPU wait time averaged over the last report period
+	EyeBufferStats getEyeBufferStats() const;
+
+	///Create a flat overlay layer showing what "camera" sees, rendered at the given resolution. Return the layer index
+	size_t createQuadLayer(Ogre::Camera* camera, size_t pixelWidth, size_t pixelHeight, Ogre::Vector2 size,
+						   Ogre::Vector3 position, Ogre::Quaternion orientation = Ogre::Quaternion::IDENTITY, bool headLocked = false);
+	///Create an overlay layer bent on a cylinder centered on "position". Return the layer index
+	size_t createCylinderLayer(Ogre::Camera* camera, size_t pixelWidth, size_t pixelHeight, float radius, float centralAngle, float height,
+							   Ogre::Vector3 position, Ogre::Quaternion orientation = Ogre::Quaternion::IDENTITY, bool headLocked = false);
+	///Ask for the content of the layer to be rendered again. Layers are only rendered when marked dirty
+	void markLayerDirty(size_t layerIndex);
+	///Move an overlay layer
+	void setLayerPose(size_t layerIndex, Ogre::Vector3 position, Ogre::Quaternion orientation);
+	///Show or hide an overlay layer
+	void setLayerVisible(size_t layerIndex, bool visible);
+
+	///Return the filter and predictor applied to the head pose. It does nothing until configured
+	PosePredictor& getHeadPosePredictor();
+
+	///Move "node" with a tracked device. The node should share its parent with the camera rig, so both are in tracking space
+	void attachTrackedDevice(VRDevice device, Ogre::SceneNode* node);
+	///Stop moving the node attached to that device
+	void detachTrackedDevice(VRDevice device);
+	///Return true if the device was tracked at the last update
+	bool isDeviceTracked(VRDevice device) const;
+	///Return the last pose of a tracked device, predicted for the same display time as the head
+	const VRPose& getDevicePose(VRDevice device) const;
+	///Return the buttons pressed on the controller held by that device. Bits are backend specific
+	uint32_t getControllerButtons(VRDevice device) const;
+
+	///Write every tracked pose used for rendering to a trace file
+	void startPoseRecording(const std::string& path);
+	///Stop writing the pose trace
+	void stopPoseRecording();
+	///Use the poses of a trace file instead of the tracking. The application stops when the trace ends
+	void startPoseReplay(const std::string& path);
+	///Return true while poses come from a trace file
+	bool isReplayingPoses() const;
+
+	///Return the texture streamer, created on first use
+	TextureStreamer* getTextureStreamer();
+	///Return the listener set on the PBS and Unlit HLMS. Chain a custom listener behind it instead of replacing it
+	StereoPassListener* getStereoPassListener();
+	///Shade point and spot lights with one clustered grid shared by both eyes, built on the scene manager worker threads.
+	///Same parameters as SceneManager::setForward3D, which it replaces : Forward3D would build one grid per eye
+	void setStereoLightGrid(bool enable, Ogre::uint32 gridWidth = 4, Ogre::uint32 gridHeight = 4, Ogre::uint32 numSlices = 5,
+							Ogre::uint32 lightsPerCell = 96, float minDistance = 3, float maxDistance = 200);
+	///Return the stereo light grid, nullptr if it's disabled
+	StereoLightGrid* getStereoLightGrid();
+	///Cast PSSM shadows from the first directional light up to "distance", computed once per frame for both eyes.
+	///The cascades from "firstCachedCascade" on are cached, see ShadowCache. Call this before initVRHardware
+	void setShadows(bool enable, size_t cascades = 3, Ogre::uint32 resolution = 2048, Ogre::Real distance = 100, size_t firstCachedCascade = 1);
+	///Return the shadow cache, to give it the light and the dynamic casters. nullptr if shadows are disabled
+	ShadowCache* getShadowCache();
+	///Render the eyes in HDR, then tone map them with eye adaptation, bloom and color grading, once for both eyes. Call this before initVRHardware
+	void setPostProcessing(bool enable);
+	///Return the post processing chain, to set the exposure and the look. nullptr if post processing is disabled
+	StereoPostProcess* getPostProcess();
+	///Only shade a checkerboard of the eyes further than "radius" from their center of projection, 1 being the edge of the viewport.
+	///The masked pixels are filled in by the post processing, enabled with it. Call this before initVRHardware
+	void setRadialDensityMask(bool enable, float radius = 0.8f);
+	///Return the radial density mask, nullptr if it's disabled
+	RadialDensityMask* getRadialDensityMask();
+	///Write the parts of the eye buffers the lenses never show to the depth buffer before the scene passes, so nothing is shaded there.
+	///The mesh comes from the runtime, or is generated outside an ellipse of "radius", 1 touching the edges of the viewport. Call this before initVRHardware
+	void setHiddenAreaMesh(bool enable, float radius = 1.0f);
+	///Return the hidden area mesh, nullptr if it's disabled or the eye buffers don't exist yet
+	HiddenAreaMesh* getHiddenAreaMesh();
+	///Return the switcher between the desktop and mobile HLMS, created on first use. Tiered materials are created through it
+	HlmsTierSwitcher* getHlmsTierSwitcher();
+	///Reload the HLMS templates when they are edited, without restarting. Needs a library declared from a folder, not a pack
+	void setHlmsHotReload(bool enable);
+	///Return the memory accounting of the renderer, to set budgets or dump it. The budgets are checked with the eye buffer report
+	MemoryTracker& getMemoryTracker();
+	///Return the arena for what only lives until the frame is submitted. It is reset after each frame, so never keep a pointer into it.
+	///Temporaries of a single function should rather go in a ScratchScope
+	LinearArena& getFrameArena();
+	///Return an empty vector allocated in the frame arena
+	template <typename T> ArenaVector<T> makeFrameVector()
+	{
+		return ArenaVector<T>(ArenaAllocator<T>(frameArena));
+	}
+
+	///Declare a resource location. It is only indexed when its group gets initialised, so startup is not blocked by it
+	void addResourceLocation(const Ogre::String& location, const Ogre::String& type = "FileSystem",
+							 const Ogre::String& group = Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	///Index and initialise a resource group now, if it hasn't been done yet
+	void requireResourceGroup(const Ogre::String& group);
+	///Return true while some declared groups are waiting to be initialised in the background
+	bool hasPendingResourceGroups() const;
+	///Time between the construction of the renderer and the first frame submitted to the headset
+	std::chrono::milliseconds getTimeToFirstFrame() const;
 
 	void updateEvents();
 	///Return true while the application should be running
@@ -72,43 +268,98 @@ public:
 				  Ogre::v1::HardwareBuffer::HBU_STATIC);
 	}
 
-	decltype(auto) asV2mesh(Ogre::String meshName,
-							Ogre::String ResourceGroup = Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-							Ogre::String sufix = " V2",
-							bool halfPos = true,
-							bool halfTextCoords = true,
-							bool qTangents = true)
-	{
-		//Get the V1 mesh
-		auto v1mesh = loadV1mesh(meshName);
-
-		//Convert it as a V2 mesh
-		auto mesh = Ogre::MeshManager::getSingletonPtr()->createManual(meshName + sufix, ResourceGroup);
-		mesh->importV1(v1mesh.get(), halfPos, halfTextCoords, qTangents);
-
-		//Unload the useless V1 mesh
-		v1mesh->unload();
-		v1mesh.setNull();
-
-		//Return the shared pointer to the new mesh
-		return mesh;
-	}
+	///Load a V1 mesh and convert it to a V2 one, with the LOD levels set by setMeshLod.
+	///The result is cached in the mesh cache folder, and loaded from there as long as the V1 mesh doesn't change
+	Ogre::MeshPtr asV2mesh(Ogre::String meshName,
+						   Ogre::String ResourceGroup = Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+						   Ogre::String sufix = " V2",
+						   bool halfPos = true,
+						   bool halfTextCoords = true,
+						   bool qTangents = true);
+	///Generate "levels" LOD levels in asV2mesh, each keeping "keepPerLevel" of the vertices of the previous one.
+	///A level is used once its error covers less than "maxPixelError" pixels of the eye buffers. 0 levels disables the generation
+	void setMeshLod(size_t levels, Ogre::Real keepPerLevel = 0.5f, Ogre::Real maxPixelError = 1.0f);
+	///Reorder the triangles of the meshes converted by asV2mesh for a vertex cache of "cacheSize" vertices, see IndexOptimiser.
+	///"reduceOverdraw" then draws the parts facing out of the mesh first. Enabled by default
+	void setIndexOptimisation(bool enable, bool reduceOverdraw = true, size_t cacheSize = 16);
+	///Pack the vertices of the meshes converted by asV2mesh. Nothing is compressed by default
+	void setVertexCompression(const VertexCompression& options);
+	///Attach an item made from an asV2mesh mesh to "node". Normalized positions need a child node giving them their size back :
+	///return the node the item ended up on
+	Ogre::SceneNode* attachItem(Ogre::SceneNode* node, Ogre::Item* item);
 
-	///Declare the HLMS library
+	///Declare the HLMS library. "path" is the HLMS folder, or the .hlmspack file packed from it at build time
 	static void declareHlmsLibrary(const Ogre::String&& path);
 	///Return the root object
 	Ogre::Root* getOgreRoot() const;
 	///This method is called to set the wanted projection matrix
 	virtual void setCorrectProjectionMatrix() = 0;
 
+protected:
+	///Create the VR runtime side of the overlay layer (its swapchain)
+	virtual void initOverlayLayer(size_t layerIndex) = 0;
+	///Enable the workspaces of the overlay layers that need to be rendered this frame
+	void prepareOverlayLayers();
+	///Create a workspace definition that clear the target and render the scene. The depth is cleared according to the depth mode
+	void createWorkspaceDef(Ogre::IdString workspaceName, const Ogre::String& nodeName, const Ogre::ColourValue& clearColor);
+	///Create the eye buffer workspace definition : one clear, then one scene pass per eye on its half of the target
+	void createStereoWorkspaceDef();
+	///In reverse depth mode, make sure every datablock test depth with "greater" instead of "less", and put "less" back out of it
+	void applyReverseDepthToDatablocks();
+	///Return the hidden area mesh of an eye from the runtime, in the UV of its half of the eye buffer, v down, 3 points per triangle.
+	///Empty if the runtime has none, one is then generated from the field of view
+	virtual std::vector<Ogre::Vector2> fetchHiddenAreaMesh(size_t eye);
+	///Create the ring of eye buffers and their workspaces. "depthTexture" is needed to read the depth back
+	void createEyeBuffers(Ogre::uint bufferWidth, Ogre::uint bufferHeight, Ogre::PixelFormat depthFormat, bool depthTexture);
+	///Move to the next eye buffer, wait until the GPU is done with it, and enable its workspace
+	EyeBuffer& acquireEyeBuffer();
+	///Mark the end of the GPU work reading the current eye buffer, and disable its workspace
+	void releaseEyeBuffer();
+	///Get the GL name of the depth buffer of an eye buffer. 0 until it has been rendered once
+	static GLuint getDepthGLID(EyeBuffer& eyeBuffer);
+	///Let the texture streamer upload its mipmaps for this frame
+	void updateTextureStreaming();
+	///Reload the HLMS whose templates have been edited. To be called by the backends before rendering the frame
+	void reloadChangedHlms();
+	///Start a frame of the upload ring, before anything is rendered. Attach the eye pass listener to the HLMS when they appear
+	void beginFrameUploads();
+	///Fence the uploads of the frame, after the last render of the frame
+	void endFrameUploads();
+	///While replaying, get the recorded pose of that device for the current frame. Return false when the live tracking should be used
+	bool replayPose(VRDevice device, VRPose& pose);
+	///Record the pose used for that device this frame, if recording
+	void recordPose(VRDevice device, const VRPose& pose);
+	///Store the pose of a device for this frame. Replayed and recorded like the head pose
+	void setDevicePose(VRDevice device, bool tracked, const VRPose& pose, uint32_t buttons);
+	///Move all the attached nodes at once, after all the device poses of the frame are known
+	void applyTrackedDevicePoses();
+	///To be called by the backends once all the poses of the frame have been handled
+	void nextTrackingFrame();
+	///To be called by the backends after each submitted frame. Initialise one pending resource group, between two frames
+	void frameSubmitted();
+
 private:
+	///Create the Ogre side of an overlay layer, shared by all the shapes
+	size_t addOverlayLayer(VROverlayLayer&& overlay, Ogre::Camera* camera);
+
 	///This load OpenGL "core" functions
 	void loadOpenGLFunctions();
 	///Initialize Ogre using a GLFW function
 	void initOgre();
 	///put all the camera attached to one single "camera rig" node
 	void attachCameraToRig(Ogre::Camera* camera);
+	///Set the projection of a regular (non VR) camera, using a reversed projection when needed
+	void updateCameraProjection(Ogre::Camera* camera, Ogre::Real aspect);
+	///Sample what Ogre and the optional subsystems allocate by themselves in the memory tracker
+	void addMemorySources();
+
+	struct PendingResourceLocation
+	{
+		Ogre::String location, type, group;
+	};
 
+	///Declared before the root : the meshes unloaded while it's destroyed still report to it
+	MemoryTracker memoryTracker;
 	std::unique_ptr<Ogre::Root> root;
 	uint8_t threads;
 	size_t width;
@@ -118,15 +369,39 @@ private:
 	GLFWwindow* glfwWindow;
 	const int glMajor, glMinor;
 
+	std::chrono::steady_clock::time_point lastAcquireTime;
+	double accumulatedFrameMs, accumulatedFenceWaitMs, accumulatedGpuMs;
+	size_t accumulatedFrames;
+	///Text of the eye buffer report. Its capacity is reserved once, so writing the report doesn't allocate
+	std::string eyeBufferReport;
+
+	std::vector<PendingResourceLocation> pendingResourceLocations;
+
+	///First depth pool of the eye buffers, away from the default one
+	static constexpr Ogre::uint16 eyeBufferDepthPool{ 100 };
+	///Folder the converted meshes are cached in, relative to the working directory
+	static constexpr const char* const meshCacheFolder{ "MeshCache" };
+	///Number of frames between two eye buffer reports
+	static constexpr size_t eyeBufferReportPeriod{ 1000 };
+	///Longest eye buffer report, in characters
+	static constexpr size_t eyeBufferReportSize{ 256 };
+	///Initial size of the frame arena. It grows to what the frames need
+	static constexpr size_t frameArenaSize{ 256 * 1024 };
+	std::chrono::steady_clock::time_point startTime;
+	std::chrono::milliseconds timeToFirstFrame;
+	bool firstFrameSubmitted;
+
 protected:
 
-	const Ogre::IdString monoscopicCompositor, stereoscopicCompositor;
+	const Ogre::IdString monoscopicCompositor, stereoscopicCompositor, overlayCompositor;
 
 	bool running;
 	Ogre::RenderWindow* window;
 	Ogre::SceneManager* smgr;
 	std::array<Ogre::Camera*, 2> stereoCameras;
 	Ogre::Camera* monoCamera;
+	///At the center of the rig. Both eyes pick their LOD from there
+	Ogre::Camera* lodCamera;
 	Ogre::SceneNode* cameraRig;
 	Ogre::ColourValue backgroundColor;
 	uint8_t AALevel;
@@ -134,7 +409,60 @@ protected:
 	double nearClippingDistance;
 	double farClippingDistance;
 
-	Ogre::CompositorWorkspace* compositorWorkspaces[3];
+	bool depthSubmission;
+	bool reverseDepth;
+	///Some datablocks may have been created since applyReverseDepthToDatablocks last walked them
+	bool datablocksChanged;
+	///Datablocks whose depth function has been reversed, by HLMS and name. The default datablocks of the HLMS share a name
+	std::set<std::pair<Ogre::HlmsTypes, Ogre::IdString>> reversedDatablocks;
+	///Far clip distance of the cameras given an infinite projection, to put back without reverse depth
+	std::map<Ogre::Camera*, Ogre::Real> reverseDepthFarClips;
+	std::vector<Ogre::CompositorPassClearDef*> clearPassDefs;
+
+	Ogre::CompositorWorkspace* monoscopicWorkspace;
+
+	size_t framesInFlight;
+	std::vector<EyeBuffer> eyeBuffers;
+	size_t currentEyeBuffer;
+	EyeBufferStats eyeBufferStats;
+
+	std::vector<VROverlayLayer> overlayLayers;
+
+	PosePredictor headPosePredictor;
+	std::unique_ptr<PoseRecorder> poseRecorder;
+	std::unique_ptr<PosePlayer> posePlayer;
+	uint32_t trackingFrame;
+
+	static constexpr size_t deviceCount{ size_t(VRDevice::Count) };
+	std::array<Ogre::SceneNode*, deviceCount> trackedDeviceNodes;
+	std::array<VRPose, deviceCount> trackedDevicePoses;
+	std::array<bool, deviceCount> trackedDeviceValid;
+	std::array<uint32_t, deviceCount> controllerButtons;
 
-	Ogre::TexturePtr rttTexture;
+	std::unique_ptr<TextureStreamer> textureStreamer;
+	std::unique_ptr<StereoPassListener> stereoPassListener;
+	std::unique_ptr<StereoLightGrid> stereoLightGrid;
+	std::unique_ptr<ShadowCache> shadowCache;
+	std::unique_ptr<StereoPostProcess> postProcess;
+	std::unique_ptr<RadialDensityMask> radialDensityMask;
+	std::unique_ptr<HiddenAreaMesh> hiddenAreaMesh;
+	bool hiddenArea;
+	float hiddenAreaRadius;
+	///Field of view of each eye. Set by the backend before it creates the eye buffers
+	std::array<VREyeFov, 2> eyeFov;
+	std::unique_ptr<HlmsTierSwitcher> hlmsTierSwitcher;
+	std::unique_ptr<HlmsHotReloader> hlmsHotReloader;
+	LinearArena frameArena;
+	std::unique_ptr<Ogre::MeshLodGenerator> meshLodGenerator;
+	size_t meshLodLevels;
+	Ogre::Real meshLodKeepPerLevel;
+	Ogre::Real meshLodMaxPixelError;
+	bool indexOptimisation;
+	bool indexOptimisationOverdraw;
+	size_t indexOptimisationCacheSize;
+	VertexCompression vertexCompression;
+	///Offset (xyz) and scale (w) of the meshes with normalized positions, by name
+	std::map<Ogre::String, Ogre::Vector4> meshDequantisation;
+	///Size in pixels of something covering a tangent of 1 in an eye buffer. Set by the backends from the eye FOV
+	Ogre::Real pixelsPerTangent;
 };
\ No newline at end of file
@@ -0,0 +1,385 @@
+#include "VertexCompressor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include <OGRE/OgreBitwise.h>
+#include <OGRE/OgreRenderable.h>
+#include <OGRE/OgreSubMesh2.h>
+#include <OGRE/OgreHardwareVertexBuffer.h>
+#include <OGRE/OgreItem.h>
+#include <OGRE/OgreSubItem.h>
+#include <OGRE/Vao/OgreAsyncTicket.h>
+#include <OGRE/Vao/OgreIndexBufferPacked.h>
+#include <OGRE/Vao/OgreVertexArrayObject.h>
+#include <OGRE/Vao/OgreVertexBufferPacked.h>
+
+namespace
+{
+	///Stops items with normalized positions from being attached at a fraction of their size
+	class DequantisationCheck : public Ogre::MovableObject::Listener
+	{
+	public:
+		void objectAttached(Ogre::MovableObject* object) override
+		{
+			throw std::runtime_error(object->getName() + " has normalized positions : attach it with VRRenderer::attachItem, its node gives them their size back");
+		}
+	} dequantisationCheck;
+
+	///Tell the templates about the normal formats the base HLMS doesn't know
+	class HlmsPbsVertexDecode : public Ogre::HlmsPbs
+	{
+	public:
+		HlmsPbsVertexDecode(Ogre::Archive* dataFolder, Ogre::ArchiveVec* libraryFolders) :
+			HlmsPbs(dataFolder, libraryFolders)
+		{
+		}
+
+	protected:
+		void calculateHashForPreCreate(Ogre::Renderable* renderable, Ogre::PiecesMap* inOutPieces) override
+		{
+			HlmsPbs::calculateHashForPreCreate(renderable, inOutPieces);
+
+			//V1 renderables have no VAO, and are never compressed
+			const auto& vaos = renderable->getVaos(Ogre::VpNormal);
+			if (vaos.empty()) return;
+
+			//The HLMS sees every item when it's created : the check is set on them before anything can attach them
+			for (const auto& elements : vaos.front()->getVertexDeclaration())
+				for (const auto& element : elements)
+					if (element.mSemantic == Ogre::VES_POSITION && element.mType == Ogre::VET_SHORT4_SNORM)
+						if (auto subItem = dynamic_cast<Ogre::SubItem*>(renderable))
+						{
+							auto item = subItem->getParent();
+							if (!item->isAttached() && !item->getListener()) item->setListener(&dequantisationCheck);
+						}
+
+			switch (VertexCompressor::getNormalPacking(renderable))
+			{
+			case NormalPacking::Octahedral:
+				setProperty(VertexCompressor::octahedralNormalProperty, 1);
+				break;
+			case NormalPacking::Int1010102:
+				setProperty(Ogre::HlmsBaseProp::QTangent, 0);
+				setProperty(Ogre::HlmsBaseProp::Normal, 1);
+				break;
+			default:
+				break;
+			}
+		}
+	};
+
+	///Read a float or half element into "out". Return false for the formats that can only be copied
+	bool readElement(Ogre::VertexElementType type, const char* source, float out[4])
+	{
+		out[0] = out[1] = out[2] = 0;
+		out[3] = 1;
+
+		switch (type)
+		{
+		case Ogre::VET_FLOAT1:
+		case Ogre::VET_FLOAT2:
+		case Ogre::VET_FLOAT3:
+		case Ogre::VET_FLOAT4:
+			std::memcpy(out, source, Ogre::v1::VertexElement::getTypeSize(type));
+			return true;
+		case Ogre::VET_HALF2:
+		case Ogre::VET_HALF4:
+			for (unsigned short i{ 0 }; i < Ogre::v1::VertexElement::getTypeCount(type); ++i)
+			{
+				uint16_t half;
+				std::memcpy(&half, source + i * sizeof half, sizeof half);
+				out[i] = Ogre::Bitwise::halfToFloat(half);
+			}
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	int16_t toSnorm16(float value)
+	{
+		return int16_t(std::lround(Ogre::Math::Clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	///x in the low bits, w on the 2 high bits. w only keeps its sign : it's the handedness of tangents
+	uint32_t toInt1010102(const float value[4])
+	{
+		const auto component = [](float v) { return uint32_t(std::lround(Ogre::Math::Clamp(v, -1.0f, 1.0f) * 511.0f)) & 0x3FFu; };
+		return component(value[0]) | component(value[1]) << 10 | component(value[2]) << 20 | (uint32_t(value[3] < 0 ? -1 : 1) & 0x3u) << 30;
+	}
+
+	///Project the normal on the octahedron |x| + |y| + |z| = 1, and unfold the lower half over the corners of the xy square
+	void octahedralEncode(const float normal[3], float out[2])
+	{
+		const auto norm = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+		auto x = norm > 0 ? normal[0] / norm : 0;
+		auto y = norm > 0 ? normal[1] / norm : 0;
+		if (normal[2] < 0)
+		{
+			const auto foldedX = (1 - std::abs(y)) * (x >= 0 ? 1 : -1);
+			y = (1 - std::abs(x)) * (y >= 0 ? 1 : -1);
+			x = foldedX;
+		}
+		out[0] = x;
+		out[1] = y;
+	}
+
+	bool isReadable(Ogre::VertexElementType type)
+	{
+		return type == Ogre::VET_FLOAT1 || type == Ogre::VET_FLOAT2 || type == Ogre::VET_FLOAT3 || type == Ogre::VET_FLOAT4 ||
+			type == Ogre::VET_HALF2 || type == Ogre::VET_HALF4;
+	}
+
+	///Format an element is stored in once compressed
+	Ogre::VertexElementType compressedType(const Ogre::VertexElement2& element, const VertexCompression& options, bool normalizePositions)
+	{
+		if (!isReadable(element.mType)) return element.mType;
+
+		switch (element.mSemantic)
+		{
+		case Ogre::VES_POSITION:
+			return normalizePositions ? Ogre::VET_SHORT4_SNORM : element.mType;
+		case Ogre::VES_NORMAL:
+			if (options.octahedralNormals) return Ogre::VET_SHORT2_SNORM;
+			return options.packedNormals ? Ogre::VET_INT_10_10_10_2_NORM : element.mType;
+		case Ogre::VES_TANGENT:
+		case Ogre::VES_BINORMAL:
+			return options.packedNormals ? Ogre::VET_INT_10_10_10_2_NORM : element.mType;
+		default:
+			return element.mType;
+		}
+	}
+
+	size_t sizeInBytes(const Ogre::VertexBufferPacked* buffer)
+	{
+		return buffer->getNumElements() * buffer->getBytesPerElement();
+	}
+}
+
+constexpr const char* const VertexCompressor::octahedralNormalProperty;
+
+Ogre::MovableObject::Listener* VertexCompressor::getDequantisationCheck()
+{
+	return &dequantisationCheck;
+}
+
+Ogre::HlmsPbs* VertexCompressor::createHlmsPbs(Ogre::Archive* dataFolder, Ogre::ArchiveVec* libraryFolders)
+{
+	return OGRE_NEW HlmsPbsVertexDecode(dataFolder, libraryFolders);
+}
+
+NormalPacking VertexCompressor::getNormalPacking(Ogre::Renderable* renderable)
+{
+	const auto& vaos = renderable->getVaos(Ogre::VpNormal);
+	if (vaos.empty()) return NormalPacking::Default;
+
+	for (const auto& elements : vaos.front()->getVertexDeclaration())
+		for (const auto& element : elements)
+			if (element.mSemantic == Ogre::VES_NORMAL)
+			{
+				if (element.mType == Ogre::VET_SHORT2_SNORM) return NormalPacking::Octahedral;
+				if (element.mType == Ogre::VET_INT_10_10_10_2_NORM) return NormalPacking::Int1010102;
+			}
+	return NormalPacking::Default;
+}
+
+std::vector<uint32_t> VertexCompressor::readIndices(Ogre::IndexBufferPacked* indexBuffer)
+{
+	std::vector<uint32_t> indices(indexBuffer->getNumElements());
+	Ogre::AsyncTicketPtr ticket = indexBuffer->readRequest(0, indexBuffer->getNumElements());
+	const auto data = ticket->map();
+	if (indexBuffer->getIndexType() == Ogre::IndexBufferPacked::IT_16BIT)
+		std::copy_n(static_cast<const uint16_t*>(data), indices.size(), indices.begin());
+	else
+		std::copy_n(static_cast<const uint32_t*>(data), indices.size(), indices.begin());
+	ticket->unmap();
+	return indices;
+}
+
+Ogre::VertexBufferPacked* VertexCompressor::convertVertexBuffer(Ogre::VertexBufferPacked* source, Ogre::VaoManager* vaoManager,
+																const VertexCompression& options, const std::vector<uint32_t>& order,
+																const Ogre::Vector3& center, Ogre::Real scale)
+{
+	const auto& sourceElements = source->getVertexElements();
+	Ogre::VertexElement2Vec elements;
+	std::vector<size_t> sourceOffsets, offsets;
+	size_t sourceStride{ 0 }, stride{ 0 };
+	for (const auto& sourceElement : sourceElements)
+	{
+		elements.push_back({ compressedType(sourceElement, options, scale > 0), sourceElement.mSemantic });
+		sourceOffsets.push_back(sourceStride);
+		offsets.push_back(stride);
+		sourceStride += Ogre::v1::VertexElement::getTypeSize(sourceElement.mType);
+		stride += Ogre::v1::VertexElement::getTypeSize(elements.back().mType);
+	}
+
+	const auto vertexCount = source->getNumElements();
+	std::vector<char> data(vertexCount * stride);
+	Ogre::AsyncTicketPtr ticket = source->readRequest(0, vertexCount);
+	const auto sourceData = static_cast<const char*>(ticket->map());
+
+	for (size_t vertex{ 0 }; vertex < vertexCount; ++vertex)
+	{
+		const auto sourceVertex = sourceData + (order.empty() ? vertex : order[vertex]) * source->getBytesPerElement();
+		const auto destination = data.data() + vertex * stride;
+
+		for (size_t i{ 0 }; i < elements.size(); ++i)
+		{
+			const auto from = sourceVertex + sourceOffsets[i];
+			const auto to = destination + offsets[i];
+			if (elements[i].mType == sourceElements[i].mType)
+			{
+				std::memcpy(to, from, Ogre::v1::VertexElement::getTypeSize(elements[i].mType));
+				continue;
+			}
+
+			float value[4];
+			readElement(sourceElements[i].mType, from, value);
+			switch (elements[i].mType)
+			{
+			case Ogre::VET_SHORT4_SNORM:
+			{
+				const int16_t position[4]{ toSnorm16((value[0] - center.x) / scale), toSnorm16((value[1] - center.y) / scale),
+										   toSnorm16((value[2] - center.z) / scale), 32767 };
+				std::memcpy(to, position, sizeof position);
+				break;
+			}
+			case Ogre::VET_SHORT2_SNORM:
+			{
+				float encoded[2];
+				octahedralEncode(value, encoded);
+				const int16_t normal[2]{ toSnorm16(encoded[0]), toSnorm16(encoded[1]) };
+				std::memcpy(to, normal, sizeof normal);
+				break;
+			}
+			default:
+			{
+				const auto packed = toInt1010102(value);
+				std::memcpy(to, &packed, sizeof packed);
+				break;
+			}
+			}
+		}
+	}
+	ticket->unmap();
+
+	return vaoManager->createVertexBuffer(elements, vertexCount, source->getBufferType(), data.data(), false);
+}
+
+VertexCompressionReport VertexCompressor::compress(Ogre::Mesh* mesh, Ogre::VaoManager* vaoManager, const VertexCompression& options,
+												   Ogre::Vector4& dequantisation)
+{
+	//Bones move the vertices in the space of the mesh, they can't be scaled back afterwards
+	const auto bounds = mesh->getAabb();
+	const auto normalizePositions = options.normalizedPositions && !mesh->hasSkeleton();
+	//One scale for the 3 axes, so the node undoing it doesn't skew the normals
+	const auto scale = normalizePositions ? std::max({ bounds.mHalfSize.x, bounds.mHalfSize.y, bounds.mHalfSize.z }) : 0;
+
+	VertexCompressionReport report{ 0, 0, 0 };
+	std::map<Ogre::VertexBufferPacked*, Ogre::VertexBufferPacked*> vertexBuffers;
+	std::map<Ogre::IndexBufferPacked*, Ogre::IndexBufferPacked*> indexBuffers;
+	std::map<Ogre::VertexArrayObject*, Ogre::VertexArrayObject*> vaos;
+	//New index to old index of the vertices, for each set of vertex buffers. Keyed by its first buffer
+	std::map<Ogre::VertexBufferPacked*, std::vector<uint32_t>> orders;
+
+	for (auto subMesh : mesh->getSubMeshes())
+		for (auto pass : { Ogre::VpNormal, Ogre::VpShadow })
+			for (auto& vao : subMesh->mVao[pass])
+			{
+				//The shadow pass often uses the VAOs of the normal one
+				const auto converted = vaos.find(vao);
+				if (converted != vaos.end())
+				{
+					vao = converted->second;
+					continue;
+				}
+
+				const auto& sourceBuffers = vao->getVertexBuffers();
+				const auto indexBuffer = vao->getIndexBuffer();
+
+				//LOD 0 comes first, and the other LODs share its vertices. Its triangles choose the order for all of them
+				auto& order = orders[sourceBuffers.front()];
+				if (options.reorderVertices && order.empty() && indexBuffer)
+				{
+					const auto vertexCount = sourceBuffers.front()->getNumElements();
+					std::vector<bool> placed(vertexCount, false);
+					for (auto index : readIndices(indexBuffer))
+						if (!placed[index])
+						{
+							placed[index] = true;
+							order.push_back(index);
+						}
+					for (uint32_t index{ 0 }; index < vertexCount; ++index)
+						if (!placed[index]) order.push_back(index);
+				}
+
+				Ogre::VertexBufferPackedVec buffers;
+				for (auto sourceBuffer : sourceBuffers)
+				{
+					auto& buffer = vertexBuffers[sourceBuffer];
+					if (!buffer)
+					{
+						buffer = convertVertexBuffer(sourceBuffer, vaoManager, options, order, bounds.mCenter, scale);
+						report.vertexBytesBefore += sizeInBytes(sourceBuffer);
+						report.vertexBytesAfter += sizeInBytes(buffer);
+						if (sourceBuffer == sourceBuffers.front()) report.vertexCount += sourceBuffer->getNumElements();
+					}
+					buffers.push_back(buffer);
+				}
+
+				Ogre::IndexBufferPacked* newIndexBuffer{ nullptr };
+				if (indexBuffer)
+				{
+					auto& remapped = indexBuffers[indexBuffer];
+					if (!remapped)
+					{
+						auto indices = readIndices(indexBuffer);
+						if (!order.empty())
+						{
+							std::vector<uint32_t> newIndexOf(order.size());
+							for (uint32_t i{ 0 }; i < order.size(); ++i)
+								newIndexOf[order[i]] = i;
+							for (auto& index : indices)
+								index = newIndexOf[index];
+						}
+
+						if (indexBuffer->getIndexType() == Ogre::IndexBufferPacked::IT_16BIT)
+						{
+							std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+							remapped = vaoManager->createIndexBuffer(Ogre::IndexBufferPacked::IT_16BIT, shortIndices.size(),
+																	 indexBuffer->getBufferType(), shortIndices.data(), false);
+						}
+						else
+							remapped = vaoManager->createIndexBuffer(Ogre::IndexBufferPacked::IT_32BIT, indices.size(),
+																	 indexBuffer->getBufferType(), indices.data(), false);
+					}
+					newIndexBuffer = remapped;
+				}
+
+				auto newVao = vaoManager->createVertexArrayObject(buffers, newIndexBuffer, vao->getOperationType());
+				newVao->setPrimitiveRange(vao->getPrimitiveStart(), vao->getPrimitiveCount());
+				vaos[vao] = newVao;
+				vao = newVao;
+			}
+
+	//Nothing refers to the old buffers anymore
+	for (const auto& vao : vaos)
+		vaoManager->destroyVertexArrayObject(vao.first);
+	for (const auto& buffer : vertexBuffers)
+		vaoManager->destroyVertexBuffer(buffer.first);
+	for (const auto& buffer : indexBuffers)
+		vaoManager->destroyIndexBuffer(buffer.first);
+
+	if (scale > 0)
+	{
+		dequantisation = { bounds.mCenter.x, bounds.mCenter.y, bounds.mCenter.z, scale };
+		mesh->_setBounds(Ogre::Aabb(Ogre::Vector3::ZERO, bounds.mHalfSize / scale), false);
+		mesh->_setBoundingSphereRadius((mesh->getBoundingSphereRadius() + bounds.mCenter.length()) / scale);
+	}
+
+	return report;
+}
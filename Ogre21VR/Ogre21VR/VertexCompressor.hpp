@@ -0,0 +1,77 @@
+#pragma once
+
+//C++ standard libraries
+#include <cstdint>
+#include <vector>
+
+//Ogre 2 libraries
+#include <OGRE/Ogre.h>
+#include <OGRE/OgreMesh2.h>
+#include <OGRE/Hlms/Pbs/OgreHlmsPbs.h>
+#include <OGRE/Vao/OgreVaoManager.h>
+
+///Vertex formats asV2mesh can pack a mesh into, on top of the half floats and QTangents of Mesh::importV1
+struct VertexCompression
+{
+	///Positions as 16 bit normalized integers relative to the bounding box. The item has to be attached with VRRenderer::attachItem,
+	///its node gives the positions their size back. Skinned meshes keep their positions
+	bool normalizedPositions;
+	///Normals as 2 16 bit normalized integers, folded on an octahedron. Decoded by the vertex shaders of both PBS tiers
+	bool octahedralNormals;
+	///Normals (unless octahedral), tangents and binormals as 10:10:10:2 normalized integers
+	bool packedNormals;
+	///Store the vertices in the order the triangles first use them, so the triangles read the vertex buffers forward
+	bool reorderVertices;
+
+	bool any() const
+	{
+		return normalizedPositions || octahedralNormals || packedNormals || reorderVertices;
+	}
+};
+
+///How the normals of a renderable are stored, for the HLMS to pick the decode of their templates
+enum class NormalPacking
+{
+	///Whatever the base HLMS knows : floats, halves or QTangents
+	Default,
+	///2 16 bit normalized integers, folded on an octahedron
+	Octahedral,
+	///10:10:10:2 normalized integers, which the base HLMS would take for a QTangent
+	Int1010102
+};
+
+///What the compression of a mesh saved
+struct VertexCompressionReport
+{
+	size_t vertexCount;
+	size_t vertexBytesBefore, vertexBytesAfter;
+};
+
+///Pack the vertex buffers of a V2 mesh in smaller formats the GPU still reads by itself, or with a few instructions in the HLMS
+class VertexCompressor
+{
+public:
+	///Property the templates of both PBS tiers decode the octahedral normals with
+	static constexpr const char* const octahedralNormalProperty{ "vr_octahedral_normal" };
+
+	///Create the PBS HLMS, with the properties telling its templates how the vertices of a renderable are packed
+	static Ogre::HlmsPbs* createHlmsPbs(Ogre::Archive* dataFolder, Ogre::ArchiveVec* libraryFolders);
+	///Return how the normals of a renderable are stored. V1 renderables are never compressed
+	static NormalPacking getNormalPacking(Ogre::Renderable* renderable);
+	///Listener the PBS HLMS gives to the items with normalized positions. It throws when one is attached anywhere but in
+	///VRRenderer::attachItem, that removes it once the dequantisation is applied
+	static Ogre::MovableObject::Listener* getDequantisationCheck();
+
+	///Replace the vertex and index buffers of every LOD of "mesh" by compressed ones. With normalized positions, "dequantisation"
+	///gets the offset (xyz) and the scale (w) to apply to the mesh to get the original positions back. It's left untouched otherwise
+	static VertexCompressionReport compress(Ogre::Mesh* mesh, Ogre::VaoManager* vaoManager, const VertexCompression& options,
+											Ogre::Vector4& dequantisation);
+
+private:
+	///Convert a vertex buffer, with its vertices in "order" (new index to old index, empty to keep them)
+	static Ogre::VertexBufferPacked* convertVertexBuffer(Ogre::VertexBufferPacked* source, Ogre::VaoManager* vaoManager,
+														 const VertexCompression& options, const std::vector<uint32_t>& order,
+														 const Ogre::Vector3& center, Ogre::Real scale);
+	///Read the indices of a buffer, whatever their size
+	static std::vector<uint32_t> readIndices(Ogre::IndexBufferPacked* indexBuffer);
+};
@@ -1,6 +1,26 @@
+#include <atomic>
+#include <fstream>
 #include <memory>
+#include <random>
+#include <sstream>
 #include "OculusVRRenderer.hpp"
 
+#ifdef _DEBUG
+#include <crtdbg.h>
+
+///Heap allocations seen by the debug CRT on the render thread since the counter was last cleared
+std::atomic<size_t> allocationCount{ 0 };
+///The hook sees the whole process : the workers of the texture streamer and of Ogre are not the render loop
+DWORD renderThreadId{ 0 };
+
+int countAllocations(int allocType, void*, size_t, int blockType, long, const unsigned char*, int)
+{
+	//The CRT's own blocks are not ours to count, and the hook must not call back into the CRT for them
+	if (allocType != _HOOK_FREE && blockType != _CRT_BLOCK && GetCurrentThreadId() == renderThreadId) ++allocationCount;
+	return TRUE;
+}
+#endif
+
 void win32stdConsole()
 {
 	AllocConsole();
@@ -14,24 +34,318 @@ Ogre::Quaternion anim()
 	return Ogre::Quaternion(Ogre::Degree(Ogre::Root::getSingleton().getTimer()->getMilliseconds() / 10), Ogre::Vector3::UNIT_Y);
 }
 
+///Record a head moving at 90Hz, to check the predictor against when no trace is given : one second at rest, then swaying and turning
+void recordSyntheticTrace(const std::string& path)
+{
+	PoseRecorder recorder{ path };
+	const double frameTime{ 1.0 / 90 };
+	for (uint32_t frame{ 0 }; frame < 900; ++frame)
+	{
+		const auto t = Ogre::Real(std::max(0.0, frame * frameTime - 1));
+		VRPose pose{};
+		pose.timestamp = frame * frameTime;
+		pose.position = Ogre::Vector3{ 0.1f * std::sin(Ogre::Math::TWO_PI * 0.5f * t), 1.6f + 0.02f * std::sin(Ogre::Math::TWO_PI * 1.3f * t),
+									   0.05f * std::sin(Ogre::Math::TWO_PI * 0.7f * t) };
+		pose.orientation = Ogre::Quaternion{ Ogre::Radian{ 0.6f * std::sin(Ogre::Math::TWO_PI * 0.4f * t) }, Ogre::Vector3::UNIT_Y }
+			* Ogre::Quaternion{ Ogre::Radian{ 0.2f * std::sin(Ogre::Math::TWO_PI * 0.9f * t) }, Ogre::Vector3::UNIT_X };
+		recorder.record(frame, VRDevice::Head, pose);
+	}
+}
+
+///Check the head pose predictor against a trace recorded with startPoseRecording, or a synthetic one if "tracePath" is empty.
+///Predicted 2 frames ahead, the poses have to land closer to the recorded ones than the poses they come from.
+///With 1mm of jitter added, the filter has to take at least half of it out
+int checkPosePrediction(std::string tracePath)
+{
+	if (tracePath.empty())
+	{
+		tracePath = "synthetic.vrtrace";
+		recordSyntheticTrace(tracePath);
+	}
+
+	//Only the poses are given to the predictor, like a backend without derivatives
+	const PosePlayer player{ tracePath };
+	std::vector<VRPose> trace;
+	VRPose pose;
+	for (uint32_t frame{ 0 }; !player.isFinished(frame); ++frame)
+		if (player.pose(frame, VRDevice::Head, pose))
+		{
+			pose.hasDerivatives = false;
+			trace.push_back(pose);
+		}
+	if (trace.size() < 100)
+	{
+		std::cout << tracePath << " has too few head poses\n";
+		return 1;
+	}
+
+	const auto angleBetween = [](const Ogre::Quaternion& a, const Ogre::Quaternion& b)
+	{
+		Ogre::Radian angle;
+		Ogre::Vector3 axis;
+		(a.Inverse() * b).ToAngleAxis(angle, axis);
+		return std::min(angle.valueRadians(), Ogre::Math::TWO_PI - angle.valueRadians());
+	};
+
+	const size_t ahead{ 2 };
+	PosePredictor predictor;
+	double predictedDistance{ 0 }, heldDistance{ 0 }, predictedAngle{ 0 }, heldAngle{ 0 };
+	for (size_t i{ 0 }; i + ahead < trace.size(); ++i)
+	{
+		const auto& future = trace[i + ahead];
+		predictor.setHorizon(future.timestamp - trace[i].timestamp);
+		const auto predicted = predictor.predict(trace[i]);
+
+		//The first pose has no velocity to predict with
+		if (i == 0) continue;
+		predictedDistance += predicted.position.distance(future.position);
+		heldDistance += trace[i].position.distance(future.position);
+		predictedAngle += angleBetween(predicted.orientation, future.orientation);
+		heldAngle += angleBetween(trace[i].orientation, future.orientation);
+	}
+
+	const auto checkedPoses = double(trace.size() - ahead - 1);
+	std::cout << "Predicted " << ahead << " frames ahead : " << 1000 * predictedDistance / checkedPoses << "mm and "
+		<< Ogre::Math::RadiansToDegrees(Ogre::Real(predictedAngle / checkedPoses)) << " degrees off, "
+		<< 1000 * heldDistance / checkedPoses << "mm and " << Ogre::Math::RadiansToDegrees(Ogre::Real(heldAngle / checkedPoses))
+		<< " degrees without prediction\n";
+	const bool predictionFailed{ predictedDistance >= heldDistance || predictedAngle >= heldAngle };
+
+	//The jitter is what's left in the second differences, the motion of a head barely has any at 90Hz
+	std::mt19937 random{ 1 };
+	std::normal_distribution<Ogre::Real> noise{ 0, 0.001f };
+	PosePredictor filter;
+	filter.setFiltering(1, 0.5f);
+	std::vector<Ogre::Vector3> noisy, filtered;
+	for (auto sample : trace)
+	{
+		sample.position += Ogre::Vector3{ noise(random), noise(random), noise(random) };
+		noisy.push_back(sample.position);
+		filtered.push_back(filter.predict(sample).position);
+	}
+
+	double noisyJitter{ 0 }, filteredJitter{ 0 };
+	for (size_t i{ 2 }; i < trace.size(); ++i)
+	{
+		noisyJitter += (noisy[i] - noisy[i - 1] * 2 + noisy[i - 2]).length();
+		filteredJitter += (filtered[i] - filtered[i - 1] * 2 + filtered[i - 2]).length();
+	}
+
+	std::cout << "Filtered jitter : " << 100 * filteredJitter / noisyJitter << "% of the added one\n";
+	const bool filterFailed{ filteredJitter * 2 >= noisyJitter };
+
+	std::cout << (predictionFailed || filterFailed ? "The pose predictor fails on " : "The pose predictor passes on ") << tracePath << "\n";
+	return predictionFailed || filterFailed ? 1 : 0;
+}
+
+///Average GPU time of the eyes over "frames" frames
+double averageGpuTime(VRRenderer* renderer, size_t frames)
+{
+	double total{ 0 };
+	for (size_t i{ 0 }; i < frames && renderer->isRunning(); ++i)
+	{
+		renderer->updateTracking();
+		renderer->renderAndSubmitFrame();
+		total += renderer->getEyeBufferStats().lastGpuMs;
+	}
+	return total / frames;
+}
+
+///Light the scene with a lot of point lights, and compare the Forward3D slice offsets computed per pixel and read from the table
+void benchmarkForward3D(VRRenderer* renderer)
+{
+	auto smgr = renderer->getSmgr();
+	smgr->setForward3D(true, 4, 4, 5, 96, 3, 200);
+	for (int x{ -8 }; x < 8; ++x)
+		for (int z{ -16 }; z < 0; ++z)
+		{
+			auto light = smgr->createLight();
+			auto node = smgr->getRootSceneNode()->createChildSceneNode();
+			node->attachObject(light);
+			node->setPosition(Ogre::Real(x), 0, Ogre::Real(z));
+			light->setType(Ogre::Light::LT_POINT);
+			light->setAttenuationBasedOnRadius(2, 0.01f);
+		}
+
+	//Let the shaders compile and the clocks settle before measuring
+	const size_t warmUpFrames{ 200 }, measuredFrames{ 1000 };
+	averageGpuTime(renderer, warmUpFrames);
+
+	for (auto table : { false, true })
+	{
+		renderer->getStereoPassListener()->setForward3DSliceTable(table);
+		averageGpuTime(renderer, warmUpFrames);
+		std::cout << "Forward3D slice offsets " << (table ? "from the table : " : "computed : ")
+			<< averageGpuTime(renderer, measuredFrames) << "ms of GPU time per frame\n";
+	}
+}
+
+///Files of the reverse depth shadow check : the head poses and the cascades measured without reverse depth
+const char* const shadowCheckTrace{ "ShadowCheck.vrtrace" };
+const char* const shadowCheckDepths{ "ShadowCheckDepths.txt" };
+
+///Let the shaders compile, then render every cascade again from where the head is, and read them back
+std::vector<ShadowCache::CascadeDepth> measureShadowDepths(VRRenderer* renderer)
+{
+	const size_t warmUpFrames{ 50 };
+	for (size_t i{ 0 }; i < warmUpFrames && renderer->isRunning(); ++i)
+	{
+		renderer->updateTracking();
+		renderer->renderAndSubmitFrame();
+	}
+	renderer->getShadowCache()->invalidate();
+	renderer->updateTracking();
+	renderer->renderAndSubmitFrame();
+	return renderer->getShadowCache()->readCascadeDepths();
+}
+
+///First launch of the reverse depth shadow check, without reverse depth : record the head poses and the cascades
+int recordShadowDepths(VRRenderer* renderer)
+{
+	renderer->startPoseRecording(shadowCheckTrace);
+	const auto reference = measureShadowDepths(renderer);
+	renderer->stopPoseRecording();
+
+	std::ofstream file{ shadowCheckDepths };
+	for (const auto& cascade : reference)
+		file << cascade.coverage << " " << cascade.averageDepth << "\n";
+	if (reference.empty() || !file)
+	{
+		std::cout << "Cannot record the shadow maps\n";
+		return 1;
+	}
+
+	std::cout << "Recorded " << reference.size() << " cascades, now run with --check-reverse-depth-shadows\n";
+	return 0;
+}
+
+///Second launch, with reverse depth set before initVRHardware : replay the recorded head poses.
+///The casters have to cover the same texels at the same depths as without reverse depth
+int checkReverseDepthShadows(VRRenderer* renderer)
+{
+	std::vector<ShadowCache::CascadeDepth> reference;
+	std::ifstream file{ shadowCheckDepths };
+	ShadowCache::CascadeDepth cascade;
+	while (file >> cascade.coverage >> cascade.averageDepth)
+		reference.push_back(cascade);
+	if (reference.empty())
+	{
+		std::cout << "No recorded shadow maps, run with --record-shadow-depths first\n";
+		return 1;
+	}
+
+	renderer->startPoseReplay(shadowCheckTrace);
+	const auto reversed = measureShadowDepths(renderer);
+
+	//Only the text rounding differs
+	const float tolerance{ 0.001f };
+	bool failed{ reference.size() != reversed.size() };
+	for (size_t i{ 0 }; !failed && i < reference.size(); ++i)
+	{
+		std::cout << "Cascade " << i << " : " << reference[i].coverage << " covered at " << reference[i].averageDepth << ", "
+			<< reversed[i].coverage << " covered at " << reversed[i].averageDepth << " with the reversed depth\n";
+		failed = Ogre::Math::Abs(reference[i].coverage - reversed[i].coverage) > tolerance
+			|| Ogre::Math::Abs(reference[i].averageDepth - reversed[i].averageDepth) > tolerance;
+	}
+
+	std::cout << (failed ? "The shadow maps differ with the reversed depth\n" : "The shadow maps are the same with the reversed depth\n");
+	return failed ? 1 : 0;
+}
+
+///Render 1000 frames and report the heap allocations the render thread makes meanwhile. Informational only : Ogre's render queue
+///allocates by itself, the count includes it. What the application adds shows up as a change from one build to the next
+int reportFrameAllocations(VRRenderer* renderer, Ogre::SceneNode* animatedNode)
+{
+#ifdef _DEBUG
+	//The first frames compile shaders and grow the arenas and pools to what the scene needs
+	const size_t warmUpFrames{ 200 }, checkedFrames{ 1000 };
+	for (size_t i{ 0 }; i < warmUpFrames && renderer->isRunning(); ++i)
+	{
+		animatedNode->setOrientation(anim());
+		renderer->updateTracking();
+		renderer->renderAndSubmitFrame();
+	}
+
+	renderThreadId = GetCurrentThreadId();
+	const auto previousHook = _CrtSetAllocHook(countAllocations);
+	size_t allocations{ 0 }, allocatingFrames{ 0 };
+	for (size_t i{ 0 }; i < checkedFrames && renderer->isRunning(); ++i)
+	{
+		allocationCount = 0;
+		animatedNode->setOrientation(anim());
+		renderer->updateTracking();
+		renderer->renderAndSubmitFrame();
+
+		allocations += allocationCount;
+		if (allocationCount) ++allocatingFrames;
+	}
+	_CrtSetAllocHook(previousHook);
+
+	std::cout << allocations << " heap allocations in " << allocatingFrames << " of " << checkedFrames << " frames, Ogre's included\n";
+#else
+	std::cout << "Counting the heap allocations needs the debug CRT, run a debug build\n";
+#endif
+	return 0;
+}
+
 INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR strCmdLine, INT)
 {
 	win32stdConsole();
+
+	//An optional trace recorded with startPoseRecording follows the flag
+	const std::string commandLine{ strCmdLine };
+	const auto posePredictionCheck = commandLine.find("--check-pose-prediction");
+	if (posePredictionCheck != std::string::npos)
+	{
+		std::istringstream arguments{ commandLine.substr(posePredictionCheck) };
+		std::string flag, tracePath;
+		arguments >> flag >> tracePath;
+		if (tracePath.compare(0, 2, "--") == 0) tracePath.clear();
+		return checkPosePrediction(tracePath);
+	}
+
+	const bool reportAllocations{ std::string(strCmdLine).find("--report-frame-allocations") != std::string::npos };
+	const bool checkReverseDepth{ std::string(strCmdLine).find("--check-reverse-depth-shadows") != std::string::npos };
+
 	std::unique_ptr<VRRenderer> Renderer = std::make_unique<OculusVRRenderer>(4, 5);
 
+	Renderer->setShadows(true);
+	Renderer->setPostProcessing(true);
+	Renderer->setRadialDensityMask(true);
+	Renderer->setHiddenAreaMesh(true);
+	if (checkReverseDepth) Renderer->setReverseDepth(true);
 	Renderer->initVRHardware();
+#ifdef _DEBUG
+	//Edit the templates while the application runs. Not while counting allocations : the watcher scans the folders on its own
 	Renderer->declareHlmsLibrary("HLMS");
+	if (!reportAllocations) Renderer->setHlmsHotReload(true);
+#else
+	Renderer->declareHlmsLibrary("HLMS.hlmspack");
+#endif
 
-	Ogre::ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem");
+	//Cards with 4GB are the floor we support. Say what takes the room before the driver runs out of it
+	auto& memoryTracker = Renderer->getMemoryTracker();
+	memoryTracker.setGpuBudget(size_t(3584) * 1024 * 1024, [&memoryTracker](const MemorySnapshot&) { memoryTracker.dump(); });
 
-	Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+	Renderer->addResourceLocation(".", "FileSystem");
 
-	//load the V1 mesh file for Suzanne exported from Blender
+	//Show the empty, tracked scene in the headset while the resources are initialised between frames
+	while (Renderer->isRunning() && Renderer->hasPendingResourceGroups())
+	{
+		Renderer->updateTracking();
+		Renderer->renderAndSubmitFrame();
+	}
+
+	//The window was closed while loading : the resource groups Suzanne needs may not be initialised
+	if (!Renderer->isRunning()) return 0;
+
+	//load the V1 mesh file for Suzanne exported from Blender. She has no normal map, so no tangent to pack
+	Renderer->setVertexCompression({ true, true, false, true });
 	auto SuzanneMesh = Renderer->asV2mesh("Suzanne.mesh");
 	auto smgr = Renderer->getSmgr();
 	auto SuzanneNode = smgr->getRootSceneNode()->createChildSceneNode();
 	auto SuzanneItem = smgr->createItem(SuzanneMesh);
-	SuzanneNode->attachObject(SuzanneItem);
+	Renderer->attachItem(SuzanneNode, SuzanneItem);
 	SuzanneNode->setPosition(0, -1, -5);
 
 	auto SunLight = smgr->createLight();
@@ -41,6 +355,25 @@ INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR strCmdLine, INT)
 	SunLight->setPowerScale(Ogre::Math::PI * 3);
 	SunLight->setDirection(Ogre::Vector3(-1, -3, -1).normalisedCopy());
 
+	//The far cascades only follow the sun and the head. Suzanne spins : she is drawn over them every frame
+	Renderer->getShadowCache()->setLight(SunLight);
+	Renderer->getShadowCache()->addDynamicCaster(SuzanneItem);
+	memoryTracker.dump();
+
+	if (std::string(strCmdLine).find("--benchmark-forward3d") != std::string::npos)
+	{
+		benchmarkForward3D(Renderer.get());
+		return 0;
+	}
+
+	if (reportAllocations)
+		return reportFrameAllocations(Renderer.get(), SuzanneNode);
+
+	if (std::string(strCmdLine).find("--record-shadow-depths") != std::string::npos)
+		return recordShadowDepths(Renderer.get());
+	if (checkReverseDepth)
+		return checkReverseDepthShadows(Renderer.get());
+
 	while (Renderer->isRunning())
 	{
 		SuzanneNode->setOrientation(anim());